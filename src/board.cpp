@@ -1,19 +1,45 @@
 #include "chess.h"
 #include "data.h"
 
+chess_t::score_t chess_t::board_t::psqt_values[2][6][64];
+uint64_t chess_t::board_t::pawn_key_values[2][6][64];
+
+void chess_t::board_t::init_incremental_values() {
+    for (uint32_t piece = 0; piece < 6; piece++) {
+        for (square_t square = 0; square < 64; square++) {
+            // black uses the white tables flipped vertically (https://www.chessprogramming.org/Color_Flipping#Flipping_an_8x8_Board)
+            score_t white_score = make_score(data::piece_square_values[0][piece][square], data::piece_square_values[1][piece][square]);
+            score_t black_score = make_score(data::piece_square_values[0][piece][square ^ 56], data::piece_square_values[1][piece][square ^ 56]);
+            psqt_values[WHITE][piece][square] = white_score;
+            psqt_values[BLACK][piece][square] = -black_score;
+            for (uint32_t color = WHITE; color <= BLACK; color++) {
+                pawn_key_values[color][piece][square] = piece == PAWN ? data::zobrist_random_data.piece[color][piece][square] : 0;
+            }
+        }
+    }
+}
+
 void chess_t::board_t::set_piece(square_t square, piece_color_t piece) {
     board[square] = piece;
-    game_state_stack.last()->zobrist_key ^= data::zobrist_random_data.piece[piece.color][piece.piece][square];
+    game_state_t *game_state = game_state_stack.last();
+    game_state->zobrist_key ^= data::zobrist_random_data.piece[piece.color][piece.piece][square];
+    game_state->pawn_key ^= pawn_key_values[piece.color][piece.piece][square];
+    game_state->psqt += psqt_values[piece.color][piece.piece][square];
+    game_state->phase += data::phase_values[piece.piece];
     bitboards[piece.color][piece.piece] |= 1ull << square;
 }
 
 void chess_t::board_t::clear_piece_bitboard(square_t square, piece_color_t piece) {
-    game_state_stack.last()->zobrist_key ^= data::zobrist_random_data.piece[piece.color][piece.piece][square];
+    game_state_t *game_state = game_state_stack.last();
+    game_state->zobrist_key ^= data::zobrist_random_data.piece[piece.color][piece.piece][square];
+    game_state->pawn_key ^= pawn_key_values[piece.color][piece.piece][square];
+    game_state->psqt -= psqt_values[piece.color][piece.piece][square];
+    game_state->phase -= data::phase_values[piece.piece];
     bitboards[piece.color][piece.piece] &= ~(1ull << square);
 }
 
 void chess_t::board_t::clear_piece(square_t square, piece_color_t piece) {
-    board[square].piece = CLEAR;
+    board[square] = { CLEAR, WHITE }; // a whole-byte store, the color of an empty square is never read
     clear_piece_bitboard(square, piece);
 }
 
@@ -164,6 +190,14 @@ void chess_t::board_t::load_fen(const char *fen) {
     }
     fen_idx++;
     sscanf(&fen[fen_idx], "%d %d", &game_state_stack.last()->half_move_clock, &game_state_stack.last()->full_moves);
+    if (nnue_network) {
+        refresh_accumulator();
+    }
+}
+
+void chess_t::board_t::refresh_accumulator() {
+    accumulators.resize(max_ply);
+    nnue_refresh(accumulator(), *this);
 }
 
 void chess_t::board_t::make_move(move_t move) {
@@ -171,6 +205,9 @@ void chess_t::board_t::make_move(move_t move) {
     // TODO: check if size is greater than max_ply
     game_state_t *new_game_state = game_state_stack.next();
     new_game_state->zobrist_key = old_game_state->zobrist_key;
+    new_game_state->pawn_key = old_game_state->pawn_key;
+    new_game_state->psqt = old_game_state->psqt;
+    new_game_state->phase = old_game_state->phase;
 
     piece_color_t start_piece = get_piece(move.from);
     piece_color_t new_piece = start_piece;
@@ -274,12 +311,58 @@ void chess_t::board_t::make_move(move_t move) {
             new_game_state->castling_rights[new_game_state->to_move][QUEENSIDE] = false;
         }
     }
+    if (nnue_network) {
+        // undo_move just pops, the previous accumulator is still on the stack
+        piece_square_t added[2] = { { new_piece, move.to } };
+        piece_square_t removed[2] = { { start_piece, move.from } };
+        uint32_t added_size = 1;
+        uint32_t removed_size = 1;
+        if (move.is_capture()) {
+            removed[removed_size++] = { captured_piece, move.flags == move_t::EN_PASSANT_CAPTURE ? new_en_passant : move.to };
+        }
+        if (move.is_castling()) {
+            castling_side_t side = move.get_castling();
+            piece_color_t rook = { ROOK, old_game_state->to_move };
+            added[added_size++] = { rook, data::rook_castling_end_squares[old_game_state->to_move][side] };
+            removed[removed_size++] = { rook, data::rook_castling_start_squares[old_game_state->to_move][side] };
+        }
+        nnue_update(accumulators[game_state_stack.size - 1], accumulators[game_state_stack.size - 2], added, added_size, removed, removed_size);
+    }
+}
+
+void chess_t::board_t::make_null_move() {
+    game_state_t *old_game_state = game_state_stack.last();
+    game_state_t *new_game_state = game_state_stack.next();
+    *new_game_state = *old_game_state;
+
+    if (old_game_state->en_passant != null_square) {
+        new_game_state->zobrist_key ^= data::zobrist_random_data.en_passant[old_game_state->en_passant % 8];
+        new_game_state->en_passant = null_square;
+    }
+    new_game_state->half_move_clock = old_game_state->half_move_clock + 1;
+    new_game_state->full_moves = old_game_state->to_move == WHITE ? old_game_state->full_moves : old_game_state->full_moves + 1;
+    new_game_state->to_move = (color_t)!old_game_state->to_move;
+    new_game_state->zobrist_key ^= data::zobrist_random_data.to_move;
+    new_game_state->captured_piece = { CLEAR, WHITE };
+    if (nnue_network) {
+        accumulators[game_state_stack.size - 1] = accumulators[game_state_stack.size - 2];
+    }
+}
+
+void chess_t::board_t::undo_null_move() {
+    game_state_stack.pop();
 }
 
 void chess_t::board_t::undo_move(move_t move) {
     game_state_t *old_game_state = game_state_stack.last();
     game_state_t *new_game_state = game_state_stack.pop();
 
+    // the popped game state already holds the old key and score, so keep the piece updates below from changing them
+    uint64_t zobrist_key = new_game_state->zobrist_key;
+    uint64_t pawn_key = new_game_state->pawn_key;
+    score_t psqt = new_game_state->psqt;
+    int32_t phase = new_game_state->phase;
+
     piece_color_t start_piece = get_piece(move.to);
     piece_color_t new_piece = start_piece;
 
@@ -312,4 +395,8 @@ void chess_t::board_t::undo_move(move_t move) {
         clear_piece(rook_end_square, rook);
         set_piece(rook_start_square, rook);
     }
+    new_game_state->zobrist_key = zobrist_key;
+    new_game_state->pawn_key = pawn_key;
+    new_game_state->psqt = psqt;
+    new_game_state->phase = phase;
 }
\ No newline at end of file
@@ -5,15 +5,25 @@
 #include <limits>
 #include <chrono>
 #include <utility>
+#include <algorithm>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <future>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <random>
+#include <bit>
+#include <new>
 #include <cstdint>
 #include <cstdio>
 #include <cctype>
 #include <cstdlib>
 #include <cstring>
 #include <cstdarg>
+#include <cmath>
 
 #include "compat.h"
 
@@ -87,35 +97,57 @@ public:
     static constexpr uint32_t max_moves = 218; // https://chess.stackexchange.com/questions/4490/maximum-possible-movement-in-a-turn
     static constexpr int32_t eval_max = INT32_MAX;
     static constexpr int32_t eval_min = -eval_max; // -eval_min with INT32_MIN would overflow
-    static constexpr int32_t transposition_table_move_score = 100;
+    static constexpr uint32_t max_search_ply = 128;
 
     FILE *log;
 
     chess_t() {
+        init_lmr_reductions();
+        board_t::init_incremental_values();
         log = fopen("glamdring.log", "w");
         if (log == nullptr) {
             // use printf for consistency with opening book failure
             printf("fopen() in chess_t::chess_t() failed: %s", strerror(errno));
             exit(1);
         }
+        timer = std::make_unique<worker_t>();
     }
+    // Lazy SMP helper threads share the main thread's log and the static transposition table
+    chess_t(chess_t &main_thread) : log(main_thread.log), main_thread(&main_thread) {}
 
-    // TODO: use 1 byte
     class piece_color_t {
     public:
-        piece_t piece;
-        color_t color;
+        // packed into one byte so the 64-square mailbox fits in a single cache line
+        piece_t piece : 4;
+        color_t color : 4;
         piece_color_t() {}
         piece_color_t(piece_t piece, color_t color) : piece(piece), color(color) {};
         piece_color_t(char c);
         operator char();
     };
 
+    static_assert(sizeof(piece_color_t) == 1);
+
     struct piece_square_t {
         piece_color_t piece;
         square_t square;
     };
 
+    // middlegame score in the low 16 bits and endgame score in the high 16 bits, so one addition updates both
+    // packing from https://www.chessprogramming.org/Tapered_Eval#Packed_Scores
+    typedef int32_t score_t;
+    static constexpr score_t make_score(int32_t mg, int32_t eg) {
+        return (score_t)((uint32_t)eg << 16) + mg;
+    }
+    static constexpr int32_t mg_score(score_t score) {
+        return (int16_t)(uint16_t)(uint32_t)score;
+    }
+    static constexpr int32_t eg_score(score_t score) {
+        // rounds up to undo the borrow from a negative middlegame score
+        return (int16_t)(uint16_t)((uint32_t)(score + 0x8000) >> 16);
+    }
+    static constexpr int32_t max_phase = 24;
+
     class board_t;
     class move_t;
 
@@ -127,6 +159,41 @@ public:
     static char piece_to_char(piece_t piece);
     static piece_t char_to_piece(char c);
 
+    // nnue.cpp
+    /*
+    768 -> 2x256 -> 1 network with a squared clipped ReLU, laid out like bullet's simple example
+    so that its quantised output loads directly. Each perspective sees (own or enemy, piece, square)
+    with the board flipped for black and squares numbered from a1.
+    */
+    static constexpr uint32_t nnue_inputs = 768;
+    static constexpr uint32_t nnue_hidden = 256;
+    static constexpr int32_t nnue_qa = 255;
+    static constexpr int32_t nnue_qb = 64;
+    static constexpr int32_t nnue_scale = 400;
+    // the SIMD output layer computes v * w in 16 bits before multiplying by v again
+    static constexpr int32_t nnue_max_output_weight = 128;
+    struct alignas(64) nnue_network_t {
+        int16_t feature_weights[nnue_inputs][nnue_hidden];
+        int16_t feature_bias[nnue_hidden];
+        int16_t output_weights[2][nnue_hidden]; // side to move, then the other side
+        int16_t output_bias;
+    };
+    struct alignas(64) nnue_accumulator_t {
+        int16_t values[2][nnue_hidden]; // indexed by perspective
+    };
+    // shared by all threads, eval() falls back to the piece-square tables while no network is loaded
+    static std::unique_ptr<nnue_network_t> nnue_network;
+    static bool load_nnue(const char *path);
+    static uint32_t nnue_feature(color_t perspective, piece_color_t piece, square_t square);
+    // output = input + added features - removed features in one pass over the accumulator
+    static void nnue_update(nnue_accumulator_t &output, const nnue_accumulator_t &input,
+                            const piece_square_t *added, uint32_t added_size,
+                            const piece_square_t *removed, uint32_t removed_size);
+    static void nnue_refresh(nnue_accumulator_t &accumulator, board_t &board);
+    static int32_t nnue_evaluate(const nnue_accumulator_t &accumulator, color_t to_move);
+    // reference implementation of nnue_evaluate, also used when AVX-512 is not available
+    static int32_t nnue_evaluate_scalar(const nnue_accumulator_t &accumulator, color_t to_move);
+
     // board.cpp
     class board_t {
     public:
@@ -136,6 +203,12 @@ public:
 
         struct game_state_t {
             uint64_t zobrist_key;
+            // zobrist_key restricted to the pawns, indexes the pawn hash table
+            uint64_t pawn_key;
+            // piece-square score, white minus black, kept up to date by the piece updates like zobrist_key
+            score_t psqt;
+            // sum of data::phase_values over all pieces, can exceed max_phase after promotions
+            int32_t phase;
             uint32_t half_move_clock;
             uint32_t full_moves;
             square_t en_passant;
@@ -144,6 +217,8 @@ public:
             piece_color_t captured_piece;
         };
         array_t<game_state_t, max_ply> game_state_stack;
+        // parallel to game_state_stack, only allocated and kept up to date while a network is loaded
+        std::vector<nnue_accumulator_t> accumulators;
 
         uint32_t last_irrev_ply;
 
@@ -151,6 +226,11 @@ public:
         piece_color_t get_piece(square_t square) {
             return board[square];
         }
+        // signed piece-square values indexed like the Zobrist keys, black's flipped and negated
+        static score_t psqt_values[2][6][64];
+        // the Zobrist piece keys for pawns and zero for every other piece, so pawn_key is updated without a branch
+        static uint64_t pawn_key_values[2][6][64];
+        static void init_incremental_values();
         void set_piece(square_t square, piece_color_t piece);
         void clear_piece_bitboard(square_t square, piece_color_t piece);
         void clear_piece(square_t square, piece_color_t piece);
@@ -160,9 +240,17 @@ public:
         void print(FILE *out = stdout);
         void clear();
         void load_fen(const char *fen);
+        nnue_accumulator_t &accumulator() {
+            return accumulators[game_state_stack.size - 1];
+        }
+        // rebuilds the accumulator of the current position from scratch
+        void refresh_accumulator();
 
         void make_move(move_t move);
         void undo_move(move_t move);
+        // passes the turn without moving a piece, used for null move pruning
+        void make_null_move();
+        void undo_null_move();
     };
     board_t board;
 
@@ -197,9 +285,10 @@ public:
             ROOK_PROMOTION_CAPTURE,
             QUEEN_PROMOTION_CAPTURE,
         };
-        packed_square_t from/*: 6 bits*/;
-        packed_square_t to/*: 6 bits*/;
-        move_flags_t flags/*: 4 bits*/;
+        // one 16-bit unit, the same type for every field so that MSVC also packs them together
+        uint16_t from : 6;
+        uint16_t to : 6;
+        uint16_t flags : 4; // move_flags_t
         move_t() {}
         
         constexpr move_t(square_t from, square_t to, move_flags_t flags) : from(from), to(to), flags(flags) {}
@@ -209,6 +298,17 @@ public:
 
         void compute_flags(board_t &board, move_flags_t promotion, const square_t (&king_castling_end_squares)[][2]);
 
+        friend bool operator ==(const move_t &a, const move_t &b) {
+            return a.from == b.from && a.to == b.to && a.flags == b.flags;
+        }
+        // 6/6/4 bit packing for the transposition table, 0 (a8a8) is never a legal move and means no move
+        uint16_t pack() {
+            return (uint16_t)(from | to << 6 | flags << 12);
+        }
+        static move_t unpack(uint16_t packed) {
+            return { packed & 0x3f, packed >> 6 & 0x3f, (move_flags_t)(packed >> 12) };
+        }
+
         bool is_capture() {
             return flags & CAPTURE;
         }
@@ -226,7 +326,15 @@ public:
         }
         void print(FILE *out = stdout);
     };
-    typedef array_t<move_t, max_moves> move_array_t;
+    static_assert(sizeof(move_t) == 2);
+    // generated moves carry their ordering score, so sorting swaps one entry instead of two parallel arrays
+    struct scored_move_t : move_t {
+        int32_t score;
+        scored_move_t() {}
+        using move_t::move_t;
+        scored_move_t(move_t move) : move_t(move) {}
+    };
+    typedef array_t<scored_move_t, max_moves> move_array_t;
 
     // transposition_table.cpp
     class transposition_table_t {
@@ -239,12 +347,14 @@ public:
         class transposition_data_t {
         public:
             int32_t eval;
-            uint8_t move_idx;
+            uint16_t move;
             uint8_t depth;
-            tranposition_type_t type;
+            // type and generation share the last byte to keep the data at 8 bytes
+            tranposition_type_t type : 2;
+            uint8_t generation : 6;
             friend bool operator ==(const transposition_data_t &a, const transposition_data_t &b) {
-                return a.eval == b.eval && a.move_idx == b.move_idx &&
-                       a.depth == b.depth && a.type == b.type;
+                return a.eval == b.eval && a.move == b.move &&
+                       a.depth == b.depth && a.type == b.type && a.generation == b.generation;
             }
             operator uint64_t() {
                 uint64_t result;
@@ -253,24 +363,52 @@ public:
                 memcpy(&result, this, sizeof(result));
                 return result;
             }
+            static transposition_data_t from_uint64(uint64_t packed) {
+                transposition_data_t result;
+                memcpy(&result, &packed, sizeof(result));
+                return result;
+            }
         };
+        /*
+        Lockless hashing from https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+        Both words are written with separate relaxed atomic stores, so a reader racing a writer
+        can see data from one store and data_xor_key from another. Such a torn entry decodes to
+        a different key and is rejected like any other miss.
+        */
         struct transposition_entry_t {
-            transposition_data_t data;
-            uint64_t data_xor_key;
+            std::atomic<uint64_t> data;
+            std::atomic<uint64_t> data_xor_key;
         };
-        transposition_entry_t *table;
-        static constexpr uint64_t size = 512 * 1024 * 1024; // must be power of two to turn key % size into key & (size - 1)
-        static constexpr uint64_t entries = size / sizeof(*table);
-        transposition_table_t() {
-            table = new transposition_entry_t[entries] {};
-        }
+        // one cache line per probe, the replacement policy picks a victim within the bucket
+        static constexpr uint32_t bucket_entries = 4;
+        struct alignas(64) transposition_bucket_t {
+            transposition_entry_t entries[bucket_entries];
+        };
+        static constexpr uint8_t max_generation = 63;
+        transposition_bucket_t *table = nullptr;
+        uint64_t buckets = 0; // always a power of two to turn key % buckets into key & mask
+        uint64_t mask = 0;
+        uint8_t generation = 0;
+        static constexpr uint64_t default_size_mb = 512;
+        static constexpr uint64_t max_size_mb = 64 * 1024;
         ~transposition_table_t() {
             delete[] table;
         }
-        transposition_entry_t lookup(uint64_t key);
-        void store(int32_t eval, uint8_t move_idx, uint64_t key, int32_t alpha, int32_t beta, uint8_t depth);
+        // replaces the table with a zeroed one of the new size, or keeps the old table and returns false if the allocation fails
+        bool resize(uint64_t size_mb);
+        // allocates the default size if no Hash option was set, called from isready and go so neither start-up nor the search pays for it
+        void allocate();
+        uint64_t size_mb();
+        void clear();
+        // ages all entries so ones from previous searches are replaced first
+        void new_search();
+        // permill of entries written during the current search (sampled from the first 1000 entries)
+        uint32_t hashfull();
+        bool lookup(uint64_t key, transposition_data_t &data);
+        // returns true if a valid entry of a different position was overwritten
+        bool store(int32_t eval, uint16_t move, uint64_t key, int32_t alpha, int32_t beta, uint8_t depth);
     };
-    transposition_table_t transposition_table;
+    static transposition_table_t transposition_table; // shared by all search threads
 
     // opening_book.cpp
     class opening_book_t {
@@ -301,8 +439,14 @@ public:
     opening_book_t opening_book;
 
     // movegen.cpp
+    enum gen_type_t : uint8_t {
+        ALL,
+        CAPTURES, // captures and promotions
+        QUIETS, // all other moves
+    };
+    template <gen_type_t gen_type>
     static void serialize_bitboard(square_t square, uint64_t moves_bitboard, uint64_t enemies, move_array_t &moves);
-    template <chess_t::color_t to_move>
+    template <chess_t::color_t to_move, gen_type_t gen_type>
     void gen_pawn_moves(uint64_t pawns, uint64_t blockers, uint64_t allies, uint64_t enemies, uint64_t legal, uint64_t (&pin_lines)[64], move_array_t &moves);
     uint64_t gen_pawn_attacks(color_t to_move, square_t square);
     uint64_t gen_knight_moves(square_t square, uint64_t allies);
@@ -318,18 +462,55 @@ public:
     
     // generates the attackers for a square
     uint64_t gen_attackers(square_t square, uint64_t blockers);
+    // generates the attackers of both colors for a square
+    uint64_t gen_all_attackers(square_t square, uint64_t blockers);
     // "king danger" terminology from https://peterellisjones.com/posts/generating-legal-chess-moves-efficiently/
     // generates all opponent's attacked squares (with the king removed to ensure it cannot go back out of check)
     uint64_t gen_king_danger_squares(uint64_t blockers);
     uint64_t gen_pinning_danger(square_t square);
     // generates all pin lines for a square
     void gen_pins(uint64_t (&pin_lines)[64], square_t square, uint64_t allies, uint64_t enemies); // TODO: use reference?
+    template <gen_type_t gen_type = ALL>
     move_array_t gen_moves();
+    // generates into an existing array, avoiding a copy when the array outlives the call (e.g. in the search stack)
+    template <gen_type_t gen_type = ALL>
+    void gen_moves(move_array_t &moves);
+    // validates moves from outside move generation (e.g. the transposition table) without generating all moves
+    bool is_pseudo_legal(move_t move);
+    // checks a pseudo-legal move does not leave the king in check
+    bool is_legal(move_t move);
     
+    // see.cpp
+    // static exchange evaluation, returns the material gained by the side to move after all captures on the move's target square
+    int32_t see(move_t move);
+    // skips the exchange when the captured piece is worth at least the capturing piece
+    bool is_losing_capture(move_t move);
+
     // eval.cpp
+    // from-scratch piece-square sum, used to check the incremental board_t::game_state_t::psqt
+    template <color_t color>
+    score_t count_material();
+    // passed, isolated, doubled and backward pawns, only depends on the pawns so it is cached by pawn_key
     template <color_t color>
-    int32_t count_material();
-    int32_t eval();
+    score_t eval_pawns(uint64_t &passed);
+    struct pawn_entry_t {
+        uint64_t key;
+        score_t score; // white minus black
+        uint64_t passed[2];
+    };
+    static constexpr uint32_t pawn_table_entries = 1 << 14; // 512 KiB per thread
+    // per thread so entries are written without synchronization, zeroed entries match the key of a position without pawns
+    std::unique_ptr<pawn_entry_t[]> pawn_table = std::make_unique<pawn_entry_t[]>(pawn_table_entries);
+    pawn_entry_t &probe_pawn_table();
+    // mobility and attacks on the enemy king zone, sharing one attack bitboard per piece
+    template <color_t color>
+    score_t eval_pieces(uint64_t blockers);
+    static bool lazy_eval;
+    // eval_pieces can reach several hundred centipawns with an all-out king attack, so its difference is clamped to this in eval()
+    static constexpr int32_t max_piece_eval = 300;
+    // positions further outside the window skip eval_pieces, the extra centipawn covers rounding when the clamped terms are tapered
+    static constexpr int32_t lazy_eval_margin = max_piece_eval + 1;
+    int32_t eval(int32_t alpha = eval_min, int32_t beta = eval_max);
 
     // draw.cpp
     bool is_repetition();
@@ -338,14 +519,157 @@ public:
 
     // search.cpp
     move_t best_move;
-    uint64_t nodes;
+    // written only by the owning thread, read by the main thread for reporting
+    std::atomic<uint64_t> nodes;
+    void count_node() {
+        nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
 
+    // set by the caller before search(), cleared by stop_search()
     std::atomic<bool> searching;
-    move_t order_moves(move_array_t &moves, uint8_t (&scores)[max_moves], uint32_t idx);
-    int32_t negamax(uint32_t depth, uint64_t max_nodes, bool root = true, int32_t alpha = eval_min, int32_t beta = eval_max);
+    // set by go ponder, the search clock starts on ponderhit
+    std::atomic<bool> pondering;
+    std::chrono::steady_clock::time_point ponder_start;
+
+    struct search_stats_t {
+        uint64_t tt_probes;
+        uint64_t tt_hits;
+        uint64_t tt_stores;
+        uint64_t tt_overwrites;
+        uint64_t qnodes;
+        uint64_t null_move_cutoffs;
+        uint64_t beta_cutoffs;
+        uint64_t first_move_cutoffs;
+        uint64_t see_prunes;
+        uint64_t pawn_probes;
+        uint64_t pawn_hits;
+        uint64_t evals;
+        uint64_t lazy_evals;
+        search_stats_t &operator +=(const search_stats_t &other) {
+            tt_probes += other.tt_probes;
+            tt_hits += other.tt_hits;
+            tt_stores += other.tt_stores;
+            tt_overwrites += other.tt_overwrites;
+            qnodes += other.qnodes;
+            null_move_cutoffs += other.null_move_cutoffs;
+            beta_cutoffs += other.beta_cutoffs;
+            first_move_cutoffs += other.first_move_cutoffs;
+            see_prunes += other.see_prunes;
+            pawn_probes += other.pawn_probes;
+            pawn_hits += other.pawn_hits;
+            evals += other.evals;
+            lazy_evals += other.lazy_evals;
+            return *this;
+        }
+    };
+    search_stats_t stats;
+
+    std::vector<std::unique_ptr<chess_t>> helpers;
+    chess_t *main_thread = nullptr; // set for helpers only
+    void set_threads(uint32_t threads);
+    uint64_t count_nodes();
+    bool node_limit_reached(uint64_t max_nodes);
+    search_stats_t count_stats();
+    uint32_t root_ply;
+    void new_search();
+
+    // per-ply state, reused by every node searched at that ply so negamax frames stay small
+    struct alignas(64) search_ply_t {
+        move_array_t moves;
+        // captures losing material by SEE, searched after the quiets
+        move_array_t bad_captures;
+        move_array_t searched_quiets;
+        move_t killers[2];
+        int32_t static_eval; // eval_min when in check or when null move pruning cannot run
+        // triangular PV table: pv holds the principal variation from this ply, filled from the next ply's pv
+        uint32_t pv_length;
+        move_t pv[max_search_ply + 1];
+    };
+    // indexed by ply, one entry past max_search_ply for the nodes that return at the ply limit
+    std::unique_ptr<search_ply_t[]> search_stack = std::make_unique<search_ply_t[]>(max_search_ply + 1);
+    struct pv_line_t {
+        int32_t eval;
+        uint32_t length;
+        move_t moves[max_search_ply + 1];
+    };
+    // MultiPV: line pv_idx is searched with the root moves of the better lines excluded
+    static constexpr uint32_t max_multi_pv = max_moves;
+    uint32_t multi_pv = 1;
+    uint32_t pv_idx;
+    move_array_t excluded_root_moves;
+    // principal variations of the last completed iteration, each searched first when its line is searched again
+    pv_line_t pv_lines[max_multi_pv];
+    bool follow_pv;
+    void update_pv(move_t move, uint32_t ply);
+    void print_pv(pv_line_t &line);
+
+    // move ordering: hash move, captures by MVV-LVA, killers, then quiets by history
+    static constexpr int32_t transposition_table_move_score = 1 << 30;
+    static constexpr int32_t capture_move_score = 1 << 20;
+    static constexpr int32_t killer_move_score = 1 << 19;
+    static constexpr int32_t max_history = 1 << 14;
+    int32_t history[2][64][64] = {};
+    int32_t score_move(move_t move, uint32_t ply);
+    void update_quiet_history(move_t cutoff_move, uint32_t depth, uint32_t ply);
+    move_t order_moves(move_array_t &moves, uint32_t idx);
+
+    // yields moves in stages, generating each stage only after the previous one is exhausted
+    class move_picker_t {
+    public:
+        enum stage_t : uint8_t {
+            HASH_MOVE,
+            GEN_CAPTURES,
+            GOOD_CAPTURES,
+            KILLERS,
+            GEN_QUIETS,
+            QUIETS,
+            BAD_CAPTURES,
+            DONE,
+        };
+        chess_t &chess;
+        stage_t stage;
+        move_t hash_move;
+        uint32_t ply;
+        uint32_t idx;
+        // the generated moves and the bad captures live in the ply's search stack entry
+        search_ply_t &ss;
+        move_array_t *excluded_moves;
+
+        // hash_move must be legal or null
+        move_picker_t(chess_t &chess, move_t hash_move, uint32_t ply, move_array_t *excluded_moves = nullptr)
+            : chess(chess), stage(HASH_MOVE), hash_move(hash_move), ply(ply), idx(0), ss(chess.search_stack[ply]), excluded_moves(excluded_moves) {
+            ss.bad_captures.size = 0;
+        }
+        // returns a null move (packed as 0) when there are no moves left
+        move_t next();
+        move_t next_staged();
+    };
+    static constexpr int32_t delta_pruning_margin = 200;
+    int32_t quiesce(int32_t alpha, int32_t beta);
+    static constexpr uint32_t null_move_min_depth = 3;
+    static bool null_move_verification; // re-search null move cutoffs without a null move to avoid zugzwang errors
+    bool has_non_pawn_material();
+
+    // late move reductions indexed by [depth][move number], lmr_base and lmr_divisor are in hundredths
+    static constexpr uint32_t lmr_max_idx = 64;
+    static constexpr uint32_t lmr_min_depth = 3;
+    static constexpr uint32_t lmr_min_move = 3;
+    static int32_t lmr_base;
+    static int32_t lmr_divisor;
+    static uint8_t lmr_reductions[lmr_max_idx][lmr_max_idx];
+    static void init_lmr_reductions();
+    int32_t negamax(uint32_t depth, uint64_t max_nodes, bool root = true, int32_t alpha = eval_min, int32_t beta = eval_max, bool allow_null_move = true);
+    static constexpr int32_t aspiration_window = 25;
+    static constexpr uint32_t aspiration_min_depth = 4;
+    int32_t aspiration_search(uint32_t depth, uint64_t max_nodes, int32_t previous_eval);
     int32_t search(uint32_t max_depth, uint64_t max_nodes, bool use_opening_book = true);
+    void search_helper(uint32_t thread_idx, uint32_t max_depth, uint64_t max_nodes);
     int32_t search_timed(std::chrono::milliseconds time, uint32_t max_depth, uint64_t max_nodes, bool use_opening_book = true);
     void stop_search();
+    // wakes threads waiting for searching or pondering to change
+    std::mutex search_mutex;
+    std::condition_variable search_cv;
+    void notify_search();
 
     // timeman.cpp
     std::chrono::milliseconds get_search_time(std::chrono::milliseconds time, std::chrono::milliseconds inc, std::chrono::milliseconds input_move_time);
@@ -360,24 +684,67 @@ public:
         std::chrono::milliseconds inc[2];
                
         bool infinite;
+        bool ponder;
 
         uint32_t max_depth;
-        uint32_t max_nodes;
+        uint64_t max_nodes;
         std::chrono::milliseconds input_move_time;
     };
 
     go_options_t parse_go_command();
     void parse_position_command();
+    void parse_setoption_command();
     int32_t search_uci(std::chrono::milliseconds time, bool infinite, uint32_t max_depth, uint64_t max_nodes);
+    bool get_ponder_move(move_t &ponder_move);
+    void ponderhit();
     void uci();
+    // returns false on quit
+    bool uci_command(char *input);
 
     // precomp.cpp
     static void gen_precomp_data();
 
     // test.cpp
     uint64_t perft(uint32_t depth, bool root = true);
+    // calls visit at every node up to depth plies below the current position, returns the number of nodes visited
+    template <typename visit_t>
+    uint64_t walk(uint32_t depth, visit_t &&visit);
+    // fills nnue_network with reproducible random weights for tests and benchmarks
+    static void random_nnue(uint32_t seed);
+    void bench(uint32_t depth);
     void test_movegen();
+    void test_movegen_split();
+    void test_move_validation();
     void test_transposition_table();
+    void test_transposition_table_concurrent();
     void test_draw();
-
+    void test_see();
+    void test_eval();
+    void test_nnue();
+    void test_uci();
+    void bench_see();
+    void bench_nnue();
+    void bench_eval();
+
+    // thread.cpp
+    // persistent thread that runs one job at a time, woken by a condition variable
+    class worker_t {
+    public:
+        worker_t();
+        ~worker_t();
+        // waits for the previous job to finish before handing over the next one
+        void run(std::function<void()> new_job);
+        void wait();
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::function<void()> job;
+        bool busy = false;
+        bool exiting = false;
+        std::thread thread; // started last, after the members it uses are initialized
+        void loop();
+    };
+    // declared last so the threads are joined before the rest of chess_t is destroyed, the worker before the timer it uses
+    std::unique_ptr<worker_t> timer; // enforces the hard deadline, main thread only
+    worker_t worker; // runs the main search for uci, or search_helper for helpers
 };
\ No newline at end of file
@@ -38,6 +38,15 @@ struct repetition_test_t {
     chess_t::move_t moves[14];
     bool repetition;
 };
+struct see_test_t {
+    const char *fen;
+    chess_t::move_t move;
+    int32_t see;
+};
+struct pawn_structure_test_t {
+    const char *fen;
+    uint64_t passed[2];
+};
 struct insufficient_material_test_t {
     const char *fen;
     bool insufficient_material;
@@ -52,11 +61,23 @@ extern const chess_t::square_t rook_castling_start_squares[][2];
 extern const chess_t::square_t rook_castling_end_squares[][2];
 extern const uint64_t pawn_attack_data[][64];
 extern const perft_result_t perft_results[6];
+extern const char *const bench_fens[12];
 extern const char piece_to_char[][7];
-extern const int16_t piece_square_values[][64];
+extern const int16_t piece_square_values[][6][64];
+extern const int32_t piece_values[];
+extern const int32_t phase_values[];
+extern const int16_t passed_pawn_values[][8];
+extern const int16_t free_passed_pawn_values[];
+extern const int16_t isolated_pawn_values[];
+extern const int16_t doubled_pawn_values[];
+extern const int16_t backward_pawn_values[];
+extern const int16_t mobility_values[][6];
+extern const int32_t king_attack_weights[];
 extern const uint8_t mvv_lva[][6];
 extern const zobrist_data_t zobrist_random_data;
 extern const zobrist_test_t zobrist_test_data[9];
 extern const repetition_test_t repetition_test_data[5];
 extern const insufficient_material_test_t insufficient_material_test_data[10];
+extern const see_test_t see_test_data[12];
+extern const pawn_structure_test_t pawn_structure_test_data[5];
 }
\ No newline at end of file
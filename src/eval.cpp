@@ -2,36 +2,195 @@
 #include "data.h"
 
 template <chess_t::color_t color>
-int32_t chess_t::count_material() {
-    int32_t material = 0;
+chess_t::score_t chess_t::count_material() {
+    score_t material = 0;
     constexpr uint32_t flip = color == WHITE ? 0 : 56; // https://www.chessprogramming.org/Color_Flipping#Flipping_an_8x8_Board
-    for (uint64_t pawns = board.bitboards[color][PAWN]; pawns; pawns = intrin::blsr(pawns)) {
-        chess_t::square_t pawn_square = (chess_t::square_t)intrin::ctz(pawns) ^ flip;
-        material += data::piece_square_values[PAWN][pawn_square];
+    for (uint32_t piece = PAWN; piece <= KING; piece++) {
+        for (uint64_t pieces = board.bitboards[color][piece]; pieces; pieces = intrin::blsr(pieces)) {
+            chess_t::square_t square = (chess_t::square_t)intrin::ctz(pieces) ^ flip;
+            material += make_score(data::piece_square_values[0][piece][square], data::piece_square_values[1][piece][square]);
+        }
     }
-    for (uint64_t knights = board.bitboards[color][KNIGHT]; knights; knights = intrin::blsr(knights)) {
-        chess_t::square_t knight_square = (chess_t::square_t)intrin::ctz(knights) ^ flip;
-        material += data::piece_square_values[KNIGHT][knight_square];
+    return material;
+}
+template chess_t::score_t chess_t::count_material<chess_t::WHITE>();
+template chess_t::score_t chess_t::count_material<chess_t::BLACK>();
+
+template <chess_t::color_t color>
+chess_t::score_t chess_t::eval_pawns(uint64_t &passed) {
+    // set-wise pawn structure from https://www.chessprogramming.org/Pawn_Spans
+    constexpr uint64_t file_a = 0x101010101010101ull;
+    constexpr uint64_t file_h = 0x8080808080808080ull;
+    // A8 is 0, so white pawns advance towards the low bits
+    auto forward = [](uint64_t bitboard) { return color == WHITE ? bitboard >> 8 : bitboard << 8; };
+    auto backward = [](uint64_t bitboard) { return color == WHITE ? bitboard << 8 : bitboard >> 8; };
+    auto fill_forward = [](uint64_t bitboard) {
+        if constexpr (color == WHITE) {
+            bitboard |= bitboard >> 8;
+            bitboard |= bitboard >> 16;
+            return bitboard | bitboard >> 32;
+        } else {
+            bitboard |= bitboard << 8;
+            bitboard |= bitboard << 16;
+            return bitboard | bitboard << 32;
+        }
+    };
+    auto fill_backward = [](uint64_t bitboard) {
+        if constexpr (color == WHITE) {
+            bitboard |= bitboard << 8;
+            bitboard |= bitboard << 16;
+            return bitboard | bitboard << 32;
+        } else {
+            bitboard |= bitboard >> 8;
+            bitboard |= bitboard >> 16;
+            return bitboard | bitboard >> 32;
+        }
+    };
+    auto sides = [](uint64_t bitboard) { return (bitboard & ~file_a) >> 1 | (bitboard & ~file_h) << 1; };
+
+    uint64_t pawns = board.bitboards[color][PAWN];
+    uint64_t enemy_pawns = board.bitboards[!color][PAWN];
+
+    // the enemy pawns move backward from our side, so their front spans fill backward
+    uint64_t enemy_front_span = fill_backward(backward(enemy_pawns));
+    uint64_t behind_own_pawns = fill_backward(backward(pawns));
+    passed = pawns & ~(enemy_front_span | sides(enemy_front_span)) & ~behind_own_pawns;
+
+    uint64_t files = fill_forward(pawns) | fill_backward(pawns);
+    uint64_t isolated = pawns & ~sides(files);
+    uint64_t doubled = pawns & behind_own_pawns;
+
+    // stop square attacked by an enemy pawn and out of reach of every pawn that could defend it
+    uint64_t attack_span = fill_forward(sides(forward(pawns)));
+    uint64_t enemy_attacks = sides(backward(enemy_pawns));
+    uint64_t backward_pawns = backward(forward(pawns) & enemy_attacks & ~attack_span) & ~isolated;
+
+    int32_t mg = 0;
+    int32_t eg = 0;
+    for (uint64_t bitboard = passed; bitboard; bitboard = intrin::blsr(bitboard)) {
+        square_t square = (square_t)intrin::ctz(bitboard);
+        uint32_t rank = color == WHITE ? 7 - square / 8 : square / 8;
+        mg += data::passed_pawn_values[0][rank];
+        eg += data::passed_pawn_values[1][rank];
     }
-    for (uint64_t bishops = board.bitboards[color][BISHOP]; bishops; bishops = intrin::blsr(bishops)) {
-        chess_t::square_t bishop_square = (chess_t::square_t)intrin::ctz(bishops) ^ flip;
-        material += data::piece_square_values[BISHOP][bishop_square];
+    int32_t isolated_count = (int32_t)intrin::popcnt(isolated);
+    int32_t doubled_count = (int32_t)intrin::popcnt(doubled);
+    int32_t backward_count = (int32_t)intrin::popcnt(backward_pawns);
+    mg += isolated_count * data::isolated_pawn_values[0] + doubled_count * data::doubled_pawn_values[0] + backward_count * data::backward_pawn_values[0];
+    eg += isolated_count * data::isolated_pawn_values[1] + doubled_count * data::doubled_pawn_values[1] + backward_count * data::backward_pawn_values[1];
+    return make_score(mg, eg);
+}
+template chess_t::score_t chess_t::eval_pawns<chess_t::WHITE>(uint64_t &passed);
+template chess_t::score_t chess_t::eval_pawns<chess_t::BLACK>(uint64_t &passed);
+
+chess_t::pawn_entry_t &chess_t::probe_pawn_table() {
+    uint64_t pawn_key = board.game_state_stack.last()->pawn_key;
+    pawn_entry_t &entry = pawn_table[pawn_key & (pawn_table_entries - 1)];
+    stats.pawn_probes++;
+    if (entry.key == pawn_key) {
+        stats.pawn_hits++;
+    } else {
+        entry.key = pawn_key;
+        entry.score = eval_pawns<WHITE>(entry.passed[WHITE]) - eval_pawns<BLACK>(entry.passed[BLACK]);
     }
-    for (uint64_t rooks = board.bitboards[color][ROOK]; rooks; rooks = intrin::blsr(rooks)) {
-        chess_t::square_t rook_square = (chess_t::square_t)intrin::ctz(rooks) ^ flip;
-        material += data::piece_square_values[ROOK][rook_square];
+#ifdef DEBUG_EVAL
+    uint64_t passed[2];
+    assert(entry.score == eval_pawns<WHITE>(passed[WHITE]) - eval_pawns<BLACK>(passed[BLACK]));
+    assert(entry.passed[WHITE] == passed[WHITE] && entry.passed[BLACK] == passed[BLACK]);
+#endif
+    return entry;
+}
+
+template <chess_t::color_t color>
+chess_t::score_t chess_t::eval_pieces(uint64_t blockers) {
+    constexpr uint64_t file_a = 0x101010101010101ull;
+    constexpr uint64_t file_h = 0x8080808080808080ull;
+    uint64_t allies = 0;
+    for (uint32_t piece = PAWN; piece <= KING; piece++) {
+        allies |= board.bitboards[color][piece];
     }
-    for (uint64_t queens = board.bitboards[color][QUEEN]; queens; queens = intrin::blsr(queens)) {
-        chess_t::square_t queen_square = (chess_t::square_t)intrin::ctz(queens) ^ flip;
-        material += data::piece_square_values[QUEEN][queen_square];
+    uint64_t enemy_pawns = board.bitboards[!color][PAWN];
+    uint64_t enemy_pawn_attacks = color == WHITE ? (enemy_pawns & ~file_a) << 7 | (enemy_pawns & ~file_h) << 9
+                                                 : (enemy_pawns & ~file_a) >> 9 | (enemy_pawns & ~file_h) >> 7;
+    // squares a piece can move to without being taken by a pawn
+    uint64_t mobility_area = ~allies & ~enemy_pawn_attacks;
+    square_t enemy_king = (square_t)intrin::ctz(board.bitboards[!color][KING]);
+    uint64_t king_zone = data::king_move_data[enemy_king] | 1ull << enemy_king;
+
+    int32_t mg = 0;
+    int32_t eg = 0;
+    uint32_t king_attackers = 0;
+    int32_t king_attack_units = 0;
+    auto add_attacks = [&](piece_t piece, uint64_t attacks) {
+        int32_t mobility = (int32_t)intrin::popcnt(attacks & mobility_area);
+        mg += mobility * data::mobility_values[0][piece];
+        eg += mobility * data::mobility_values[1][piece];
+        int32_t king_zone_attacks = (int32_t)intrin::popcnt(attacks & king_zone);
+        king_attackers += king_zone_attacks != 0;
+        king_attack_units += king_zone_attacks * data::king_attack_weights[piece];
+    };
+    for (uint64_t pieces = board.bitboards[color][KNIGHT]; pieces; pieces = intrin::blsr(pieces)) {
+        add_attacks(KNIGHT, gen_knight_moves((square_t)intrin::ctz(pieces), allies));
     }
-    return material;
+    for (uint64_t pieces = board.bitboards[color][BISHOP]; pieces; pieces = intrin::blsr(pieces)) {
+        add_attacks(BISHOP, gen_bishop_moves((square_t)intrin::ctz(pieces), blockers, allies));
+    }
+    for (uint64_t pieces = board.bitboards[color][ROOK]; pieces; pieces = intrin::blsr(pieces)) {
+        add_attacks(ROOK, gen_rook_moves((square_t)intrin::ctz(pieces), blockers, allies));
+    }
+    for (uint64_t pieces = board.bitboards[color][QUEEN]; pieces; pieces = intrin::blsr(pieces)) {
+        add_attacks(QUEEN, gen_queen_moves((square_t)intrin::ctz(pieces), blockers, allies));
+    }
+    // a single attacker is rarely dangerous, the penalty grows quadratically with the attack units beyond that
+    if (king_attackers >= 2) {
+        mg += std::min(king_attack_units * king_attack_units / 8, 500);
+    }
+    return make_score(mg, eg);
 }
+template chess_t::score_t chess_t::eval_pieces<chess_t::WHITE>(uint64_t blockers);
+template chess_t::score_t chess_t::eval_pieces<chess_t::BLACK>(uint64_t blockers);
+
+bool chess_t::lazy_eval = true;
+
+int32_t chess_t::eval(int32_t alpha, int32_t beta) {
+    board_t::game_state_t *game_state = board.game_state_stack.last();
+    if (nnue_network) {
+#ifdef DEBUG_EVAL
+        nnue_accumulator_t accumulator;
+        nnue_refresh(accumulator, board);
+        assert(!memcmp(&accumulator, &board.accumulator(), sizeof(accumulator)));
+#endif
+        return nnue_evaluate(board.accumulator(), game_state->to_move);
+    }
+    stats.evals++;
+    score_t score = game_state->psqt;
+#ifdef DEBUG_EVAL
+    assert(score == count_material<WHITE>() - count_material<BLACK>());
+#endif
+    pawn_entry_t &pawns = probe_pawn_table();
+    score += pawns.score;
+    // the cached passed pawns let the terms that depend on other pieces skip the pawn scan
+    uint64_t occupied = gen_blockers();
+    int32_t free_passed = (int32_t)intrin::popcnt(pawns.passed[WHITE] & ~(occupied << 8)) - (int32_t)intrin::popcnt(pawns.passed[BLACK] & ~(occupied >> 8));
+    score += free_passed * make_score(data::free_passed_pawn_values[0], data::free_passed_pawn_values[1]);
 
-int32_t chess_t::eval() {
-    int32_t eval = 0;
-    eval += count_material<WHITE>();
-    eval -= count_material<BLACK>();
-    int32_t color_coef = board.game_state_stack.last()->to_move == WHITE ? 1 : -1;
-    return eval * color_coef;
-}
\ No newline at end of file
+    // tapered eval: interpolate between the endgame and middlegame scores by the material left on the board
+    int32_t phase = std::min(game_state->phase, max_phase);
+    int32_t color_coef = game_state->to_move == WHITE ? 1 : -1;
+    auto taper = [phase, color_coef](score_t score) {
+        int32_t mg = mg_score(score);
+        int32_t eg = eg_score(score);
+        return (eg + (mg - eg) * phase / max_phase) * color_coef;
+    };
+    if (lazy_eval) {
+        int32_t lazy = taper(score);
+        if (lazy + lazy_eval_margin <= alpha || lazy - lazy_eval_margin >= beta) {
+            stats.lazy_evals++;
+            return lazy;
+        }
+    }
+    // clamped so the lazy value above is never more than lazy_eval_margin from the full eval
+    score_t pieces = eval_pieces<WHITE>(occupied) - eval_pieces<BLACK>(occupied);
+    score += make_score(std::clamp(mg_score(pieces), -max_piece_eval, max_piece_eval), std::clamp(eg_score(pieces), -max_piece_eval, max_piece_eval));
+    return taper(score);
+}
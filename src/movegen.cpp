@@ -1,22 +1,40 @@
 #include "chess.h"
 #include "data.h"
 
+template <chess_t::gen_type_t gen_type>
 void chess_t::serialize_bitboard(square_t square, uint64_t moves_bitboard, uint64_t enemies, move_array_t &moves) {
     for ( ; moves_bitboard; moves_bitboard = intrin::blsr(moves_bitboard)) { // clear lowest bit
         square_t end_square = (square_t)intrin::ctz(moves_bitboard); // count trailing zeros
-        uint64_t lsb = intrin::blsi(moves_bitboard); // isolate lowest bit
-        move_t::move_flags_t flags = lsb & enemies ? move_t::CAPTURE : move_t::QUIET;
+        move_t::move_flags_t flags;
+        // targets are already masked for captures and quiets, so the flag is known at compile time
+        if constexpr (gen_type == CAPTURES) {
+            flags = move_t::CAPTURE;
+        } else if constexpr (gen_type == QUIETS) {
+            flags = move_t::QUIET;
+        } else {
+            uint64_t lsb = intrin::blsi(moves_bitboard); // isolate lowest bit
+            flags = lsb & enemies ? move_t::CAPTURE : move_t::QUIET;
+        }
         moves.add({square, end_square, flags});
     }
 }
 
 // TODO: template if promotion is possible for any piece to speed up loop checks
-template <chess_t::color_t to_move> 
+template <chess_t::color_t to_move, chess_t::gen_type_t gen_type> 
 void chess_t::gen_pawn_moves(uint64_t pawns, uint64_t blockers, uint64_t allies, uint64_t enemies, uint64_t legal, uint64_t (&pin_lines)[64], move_array_t &moves) {
     constexpr color_t other_to_move = (color_t)!to_move;
 
+    constexpr uint64_t rank_1 = 0xff00000000000000ull;
+    constexpr uint64_t rank_8 = 0xffull;
+    constexpr uint64_t promotion_rank = to_move == WHITE ? rank_8 : rank_1;
+    // promotions are generated with captures, not quiets
+    constexpr uint64_t single_move_targets = gen_type == CAPTURES ? promotion_rank : gen_type == QUIETS ? ~promotion_rank : 0xffffffffffffffffull;
+    if constexpr (gen_type == QUIETS) {
+        enemies = 0ull;
+    }
+
     uint64_t single_move = (to_move == WHITE ? pawns >> 8 : pawns << 8) & ~blockers;
-    for (uint64_t moves_bitboard = single_move & legal; moves_bitboard; moves_bitboard = intrin::blsr(moves_bitboard)) {
+    for (uint64_t moves_bitboard = single_move & legal & single_move_targets; moves_bitboard; moves_bitboard = intrin::blsr(moves_bitboard)) {
         square_t end_square = (square_t)intrin::ctz(moves_bitboard);
         square_t start_square = end_square + (to_move == WHITE ? 8 : -8);
         if (1ull << end_square & ~pin_lines[start_square]) {
@@ -33,7 +51,7 @@ void chess_t::gen_pawn_moves(uint64_t pawns, uint64_t blockers, uint64_t allies,
     constexpr uint64_t rank_4 = 0xff00000000ull;
     constexpr uint64_t rank_5 = 0xff000000ull;
     constexpr uint64_t double_move_rank = to_move == WHITE ? rank_4 : rank_5;
-    uint64_t double_move = (to_move == WHITE ? single_move >> 8 : single_move << 8) & ~blockers & double_move_rank & legal;
+    uint64_t double_move = gen_type == CAPTURES ? 0ull : (to_move == WHITE ? single_move >> 8 : single_move << 8) & ~blockers & double_move_rank & legal;
     for ( ; double_move; double_move = intrin::blsr(double_move)) {
         square_t end_square = (square_t)intrin::ctz(double_move);
         square_t start_square = end_square + (to_move == WHITE ? 16 : -16);
@@ -76,7 +94,7 @@ void chess_t::gen_pawn_moves(uint64_t pawns, uint64_t blockers, uint64_t allies,
         }
     }
     square_t en_passant = board.game_state_stack.last()->en_passant;
-    if (en_passant != null_square) {
+    if (gen_type != QUIETS && en_passant != null_square) {
         // check if en passant is pinned
         uint64_t en_passant_bitboard = 1ull << en_passant;
         uint64_t capture_bitboard = 1ull << (en_passant + (to_move == WHITE ? 8 : -8));
@@ -201,6 +219,20 @@ uint64_t chess_t::gen_attackers(square_t square, uint64_t blockers) {
     return attackers;
 }
 
+uint64_t chess_t::gen_all_attackers(square_t square, uint64_t blockers) {
+    uint64_t bishop_queen = board.bitboards[WHITE][BISHOP] | board.bitboards[BLACK][BISHOP] | board.bitboards[WHITE][QUEEN] | board.bitboards[BLACK][QUEEN];
+    uint64_t rook_queen = board.bitboards[WHITE][ROOK] | board.bitboards[BLACK][ROOK] | board.bitboards[WHITE][QUEEN] | board.bitboards[BLACK][QUEEN];
+    uint64_t attackers = 0ull;
+    // a pawn attacks the square if a pawn of the other color on the square would attack it
+    attackers |= gen_pawn_attacks(BLACK, square) & board.bitboards[WHITE][PAWN];
+    attackers |= gen_pawn_attacks(WHITE, square) & board.bitboards[BLACK][PAWN];
+    attackers |= gen_knight_moves(square, 0ull) & (board.bitboards[WHITE][KNIGHT] | board.bitboards[BLACK][KNIGHT]);
+    attackers |= gen_bishop_moves(square, blockers, 0ull) & bishop_queen;
+    attackers |= gen_rook_moves(square, blockers, 0ull) & rook_queen;
+    attackers |= gen_king_moves(square, 0ull) & (board.bitboards[WHITE][KING] | board.bitboards[BLACK][KING]);
+    return attackers;
+}
+
 uint64_t chess_t::gen_king_danger_squares(uint64_t blockers) {
     color_t to_move = board.game_state_stack.last()->to_move;
     color_t other_to_move = (color_t)!to_move;
@@ -313,8 +345,9 @@ void chess_t::gen_pins(uint64_t (&pin_lines)[64], square_t square, uint64_t alli
     }
 }
 
-chess_t::move_array_t chess_t::gen_moves() {
-    move_array_t moves;
+template <chess_t::gen_type_t gen_type>
+void chess_t::gen_moves(move_array_t &moves) {
+    moves.size = 0;
     
     color_t to_move = board.game_state_stack.last()->to_move;
 
@@ -322,6 +355,10 @@ chess_t::move_array_t chess_t::gen_moves() {
     uint64_t allies = gen_allies();
     uint64_t enemies = blockers & ~allies;
 
+    constexpr uint64_t all = 0xffffffffffffffffull;
+    // pawn targets are handled separately in gen_pawn_moves (promotions and en passant do not capture on the target square)
+    uint64_t targets = gen_type == CAPTURES ? enemies : gen_type == QUIETS ? ~blockers : all;
+
     square_t king_square = (square_t)intrin::ctz(board.bitboards[to_move][KING]);
 
     uint64_t checkers = gen_attackers(king_square, blockers);
@@ -332,14 +369,14 @@ chess_t::move_array_t chess_t::gen_moves() {
     
     // assumes one king
     {
-        uint64_t moves_bitboard = gen_king_moves(king_square, allies);
+        uint64_t moves_bitboard = gen_king_moves(king_square, allies) & targets;
         moves_bitboard &= ~danger;
-        serialize_bitboard(king_square, moves_bitboard, enemies, moves);
+        serialize_bitboard<gen_type>(king_square, moves_bitboard, enemies, moves);
     }
 
     // only king moves allowed when in double check
     if (num_checkers > 1) {
-        return moves;
+        return;
     }
 
     uint64_t pin_lines[64];
@@ -359,35 +396,159 @@ chess_t::move_array_t chess_t::gen_moves() {
         default:
             break;
         }
-    } else {
+    } else if (gen_type != CAPTURES) {
         gen_castling_moves(king_square, blockers, danger, moves);
     }
 
 
     if (to_move == WHITE) {
-        gen_pawn_moves<WHITE>(board.bitboards[to_move][PAWN], blockers, allies, enemies, legal, pin_lines, moves);
+        gen_pawn_moves<WHITE, gen_type>(board.bitboards[to_move][PAWN], blockers, allies, enemies, legal, pin_lines, moves);
     } else {
-        gen_pawn_moves<BLACK>(board.bitboards[to_move][PAWN], blockers, allies, enemies, legal, pin_lines, moves);    
+        gen_pawn_moves<BLACK, gen_type>(board.bitboards[to_move][PAWN], blockers, allies, enemies, legal, pin_lines, moves);    
     }
+    legal &= targets;
     for (uint64_t knights = board.bitboards[to_move][KNIGHT]; knights; knights = intrin::blsr(knights)) {
         square_t knight_square = (square_t)intrin::ctz(knights);
         uint64_t moves_bitboard = gen_knight_moves(knight_square, allies) & legal & pin_lines[knight_square];
-        serialize_bitboard(knight_square, moves_bitboard, enemies, moves);
+        serialize_bitboard<gen_type>(knight_square, moves_bitboard, enemies, moves);
     }
     for (uint64_t bishops = board.bitboards[to_move][BISHOP]; bishops; bishops = intrin::blsr(bishops)) {
         square_t bishop_square = (square_t)intrin::ctz(bishops);
         uint64_t moves_bitboard = gen_bishop_moves(bishop_square, blockers, allies) & legal & pin_lines[bishop_square];
-        serialize_bitboard(bishop_square, moves_bitboard, enemies, moves);
+        serialize_bitboard<gen_type>(bishop_square, moves_bitboard, enemies, moves);
     }
     for (uint64_t rooks = board.bitboards[to_move][ROOK]; rooks; rooks = intrin::blsr(rooks)) {
         square_t rook_square = (square_t)intrin::ctz(rooks);
         uint64_t moves_bitboard = gen_rook_moves(rook_square, blockers, allies) & legal & pin_lines[rook_square];
-        serialize_bitboard(rook_square, moves_bitboard, enemies, moves);
+        serialize_bitboard<gen_type>(rook_square, moves_bitboard, enemies, moves);
     }
     for (uint64_t queens = board.bitboards[to_move][QUEEN]; queens; queens = intrin::blsr(queens)) {
         square_t queen_square = (square_t)intrin::ctz(queens);
         uint64_t moves_bitboard = gen_queen_moves(queen_square, blockers, allies) & legal & pin_lines[queen_square];
-        serialize_bitboard(queen_square, moves_bitboard, enemies, moves);
+        serialize_bitboard<gen_type>(queen_square, moves_bitboard, enemies, moves);
     }
+}
+
+template <chess_t::gen_type_t gen_type>
+chess_t::move_array_t chess_t::gen_moves() {
+    move_array_t moves;
+    gen_moves<gen_type>(moves);
     return moves;
-}
\ No newline at end of file
+}
+template chess_t::move_array_t chess_t::gen_moves<chess_t::ALL>();
+template chess_t::move_array_t chess_t::gen_moves<chess_t::CAPTURES>();
+template chess_t::move_array_t chess_t::gen_moves<chess_t::QUIETS>();
+template void chess_t::gen_moves<chess_t::ALL>(move_array_t &moves);
+template void chess_t::gen_moves<chess_t::CAPTURES>(move_array_t &moves);
+template void chess_t::gen_moves<chess_t::QUIETS>(move_array_t &moves);
+bool chess_t::is_pseudo_legal(move_t move) {
+    board_t::game_state_t *game_state = board.game_state_stack.last();
+    color_t to_move = game_state->to_move;
+
+    piece_color_t start_piece = board.get_piece(move.from);
+    piece_color_t end_piece = board.get_piece(move.to);
+
+    if (move.from == move.to || start_piece.piece == CLEAR || start_piece.color != to_move) {
+        return false;
+    }
+    if (end_piece.piece != CLEAR && end_piece.color == to_move) {
+        return false;
+    }
+
+    uint64_t to_bitboard = 1ull << move.to;
+
+    // en passant is the only capture onto an empty square
+    if (move.flags == move_t::EN_PASSANT_CAPTURE) {
+        return start_piece.piece == PAWN && move.to == game_state->en_passant && (gen_pawn_attacks(to_move, move.from) & to_bitboard);
+    }
+    if (move.is_capture() != (end_piece.piece != CLEAR)) {
+        return false;
+    }
+
+    uint64_t blockers = gen_blockers();
+
+    switch (start_piece.piece) {
+    case PAWN: {
+        bool promotion_rank = to_move == WHITE ? move.to < 8 : move.to > 55;
+        if (move.is_promotion() != promotion_rank) {
+            return false;
+        }
+        if (move.is_capture()) {
+            return (move.is_promotion() || move.flags == move_t::CAPTURE) && (gen_pawn_attacks(to_move, move.from) & to_bitboard);
+        }
+        square_t forward = to_move == WHITE ? -8 : 8;
+        if (move.flags == move_t::DOUBLE_PAWN_PUSH) {
+            bool start_rank = to_move == WHITE ? move.from >= A2 && move.from <= H2 : move.from >= A7 && move.from <= H7;
+            return start_rank && move.to == move.from + 2 * forward && !(blockers & 1ull << (move.from + forward));
+        }
+        return (move.is_promotion() || move.flags == move_t::QUIET) && move.to == move.from + forward;
+    }
+    case KING:
+        if (move.is_castling()) {
+            castling_side_t side = move.get_castling();
+            return move.from == data::king_castling_start_squares[to_move] &&
+                   move.to == data::king_castling_end_squares[to_move][side] &&
+                   game_state->castling_rights[to_move][side] &&
+                   !(blockers & data::king_castling_clear[to_move][side]);
+        }
+        break;
+    default:
+        break;
+    }
+
+    // remaining pieces only have plain quiet moves and captures
+    if (move.flags != move_t::QUIET && move.flags != move_t::CAPTURE) {
+        return false;
+    }
+
+    uint64_t moves_bitboard = 0ull;
+    switch (start_piece.piece) {
+    case KNIGHT:
+        moves_bitboard = gen_knight_moves(move.from, 0ull);
+        break;
+    case BISHOP:
+        moves_bitboard = gen_bishop_moves(move.from, blockers, 0ull);
+        break;
+    case ROOK:
+        moves_bitboard = gen_rook_moves(move.from, blockers, 0ull);
+        break;
+    case QUEEN:
+        moves_bitboard = gen_queen_moves(move.from, blockers, 0ull);
+        break;
+    case KING:
+        moves_bitboard = gen_king_moves(move.from, 0ull);
+        break;
+    default:
+        break;
+    }
+    return moves_bitboard & to_bitboard;
+}
+
+bool chess_t::is_legal(move_t move) {
+    color_t to_move = board.game_state_stack.last()->to_move;
+    uint64_t blockers = gen_blockers();
+    square_t king_square = (square_t)intrin::ctz(board.bitboards[to_move][KING]);
+
+    // the king cannot castle out of, through, or into check
+    if (move.is_castling()) {
+        if (gen_attackers(king_square, blockers)) {
+            return false;
+        }
+        for (uint64_t safe = data::king_castling_safe[to_move][move.get_castling()]; safe; safe = intrin::blsr(safe)) {
+            if (gen_attackers((square_t)intrin::ctz(safe), blockers)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // update the blockers as if the move was made and check if any remaining enemy piece attacks the king
+    uint64_t to_bitboard = 1ull << move.to;
+    uint64_t captured = move.flags == move_t::EN_PASSANT_CAPTURE ? 1ull << (to_move == WHITE ? move.to + 8 : move.to - 8) : to_bitboard;
+    blockers = (blockers & ~(1ull << move.from) & ~captured) | to_bitboard;
+
+    if (board.get_piece(move.from).piece == KING) {
+        king_square = move.to;
+    }
+    return !(gen_attackers(king_square, blockers) & ~captured);
+}
@@ -0,0 +1,123 @@
+#include "chess.h"
+
+std::unique_ptr<chess_t::nnue_network_t> chess_t::nnue_network;
+
+bool chess_t::load_nnue(const char *path) {
+    // raw little-endian int16 arrays in the order of nnue_network_t, trailing padding is ignored
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::unique_ptr<nnue_network_t> network = std::make_unique<nnue_network_t>();
+    bool result = fread(network->feature_weights, sizeof(network->feature_weights), 1, file) == 1 &&
+                  fread(network->feature_bias, sizeof(network->feature_bias), 1, file) == 1 &&
+                  fread(network->output_weights, sizeof(network->output_weights), 1, file) == 1 &&
+                  fread(&network->output_bias, sizeof(network->output_bias), 1, file) == 1;
+    fclose(file);
+    for (uint32_t perspective = 0; perspective < 2; perspective++) {
+        for (int16_t weight : network->output_weights[perspective]) {
+            result &= std::abs(weight) <= nnue_max_output_weight;
+        }
+    }
+    if (result) {
+        nnue_network = std::move(network);
+    }
+    return result;
+}
+
+uint32_t chess_t::nnue_feature(color_t perspective, piece_color_t piece, square_t square) {
+    // A8 is 0 here, so white flips to number squares from a1 and black sees the board as is
+    square_t relative_square = perspective == WHITE ? square ^ 56 : square;
+    return (piece.color != perspective) * 384 + piece.piece * 64 + relative_square;
+}
+
+void chess_t::nnue_update(nnue_accumulator_t &output, const nnue_accumulator_t &input,
+                          const piece_square_t *added, uint32_t added_size,
+                          const piece_square_t *removed, uint32_t removed_size) {
+    for (uint32_t perspective = WHITE; perspective <= BLACK; perspective++) {
+        const int16_t *added_weights[2];
+        const int16_t *removed_weights[2];
+        for (uint32_t i = 0; i < added_size; i++) {
+            added_weights[i] = nnue_network->feature_weights[nnue_feature((color_t)perspective, added[i].piece, added[i].square)];
+        }
+        for (uint32_t i = 0; i < removed_size; i++) {
+            removed_weights[i] = nnue_network->feature_weights[nnue_feature((color_t)perspective, removed[i].piece, removed[i].square)];
+        }
+        const int16_t *in = input.values[perspective];
+        int16_t *out = output.values[perspective];
+#if defined(__AVX512BW__)
+        // the accumulator stays in registers across all feature rows, one load and one store per 32 values
+        for (uint32_t i = 0; i < nnue_hidden; i += 32) {
+            __m512i values = _mm512_load_si512(&in[i]);
+            for (uint32_t j = 0; j < added_size; j++) {
+                values = _mm512_add_epi16(values, _mm512_load_si512(&added_weights[j][i]));
+            }
+            for (uint32_t j = 0; j < removed_size; j++) {
+                values = _mm512_sub_epi16(values, _mm512_load_si512(&removed_weights[j][i]));
+            }
+            _mm512_store_si512(&out[i], values);
+        }
+#else
+        for (uint32_t i = 0; i < nnue_hidden; i++) {
+            int16_t value = in[i];
+            for (uint32_t j = 0; j < added_size; j++) {
+                value += added_weights[j][i];
+            }
+            for (uint32_t j = 0; j < removed_size; j++) {
+                value -= removed_weights[j][i];
+            }
+            out[i] = value;
+        }
+#endif
+    }
+}
+
+void chess_t::nnue_refresh(nnue_accumulator_t &accumulator, board_t &board) {
+    for (uint32_t perspective = WHITE; perspective <= BLACK; perspective++) {
+        int16_t *values = accumulator.values[perspective];
+        memcpy(values, nnue_network->feature_bias, sizeof(nnue_network->feature_bias));
+        for (square_t square = 0; square < 64; square++) {
+            piece_color_t piece = board.get_piece(square);
+            if (piece.piece == CLEAR) {
+                continue;
+            }
+            const int16_t *weights = nnue_network->feature_weights[nnue_feature((color_t)perspective, piece, square)];
+            for (uint32_t i = 0; i < nnue_hidden; i++) {
+                values[i] += weights[i];
+            }
+        }
+    }
+}
+
+int32_t chess_t::nnue_evaluate(const nnue_accumulator_t &accumulator, color_t to_move) {
+#if defined(__AVX512BW__)
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i qa = _mm512_set1_epi16(nnue_qa);
+    __m512i sum = _mm512_setzero_si512();
+    const int16_t *values[2] = { accumulator.values[to_move], accumulator.values[!to_move] };
+    for (uint32_t side = 0; side < 2; side++) {
+        for (uint32_t i = 0; i < nnue_hidden; i += 32) {
+            __m512i value = _mm512_min_epi16(_mm512_max_epi16(_mm512_load_si512(&values[side][i]), zero), qa);
+            __m512i weight = _mm512_load_si512(&nnue_network->output_weights[side][i]);
+            // value * weight fits in 16 bits, madd multiplies by value again and sums pairs into 32 bits
+            sum = _mm512_add_epi32(sum, _mm512_madd_epi16(value, _mm512_mullo_epi16(value, weight)));
+        }
+    }
+    int32_t output = _mm512_reduce_add_epi32(sum);
+    return (output / nnue_qa + nnue_network->output_bias) * nnue_scale / (nnue_qa * nnue_qb);
+#else
+    return nnue_evaluate_scalar(accumulator, to_move);
+#endif
+}
+
+int32_t chess_t::nnue_evaluate_scalar(const nnue_accumulator_t &accumulator, color_t to_move) {
+    const int16_t *values[2] = { accumulator.values[to_move], accumulator.values[!to_move] };
+    int32_t output = 0;
+    for (uint32_t side = 0; side < 2; side++) {
+        for (uint32_t i = 0; i < nnue_hidden; i++) {
+            int32_t value = std::clamp<int32_t>(values[side][i], 0, nnue_qa);
+            output += value * value * nnue_network->output_weights[side][i];
+        }
+    }
+    return (output / nnue_qa + nnue_network->output_bias) * nnue_scale / (nnue_qa * nnue_qb);
+}
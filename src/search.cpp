@@ -1,117 +1,485 @@
 #include "chess.h"
 #include "data.h"
 
-chess_t::move_t chess_t::order_moves(move_array_t &moves, uint8_t (&scores)[max_moves], uint32_t i) {
+bool chess_t::null_move_verification = false;
+int32_t chess_t::lmr_base = 75;
+int32_t chess_t::lmr_divisor = 225;
+uint8_t chess_t::lmr_reductions[lmr_max_idx][lmr_max_idx];
+
+void chess_t::init_lmr_reductions() {
+    // logarithmic formula from https://www.chessprogramming.org/Late_Move_Reductions
+    for (uint32_t depth = 1; depth < lmr_max_idx; depth++) {
+        for (uint32_t move_number = 1; move_number < lmr_max_idx; move_number++) {
+            double reduction = lmr_base / 100.0 + std::log(depth) * std::log(move_number) / (lmr_divisor / 100.0);
+            lmr_reductions[depth][move_number] = (uint8_t)std::clamp(reduction, 0.0, (double)depth - 1);
+        }
+    }
+}
+
+chess_t::move_t chess_t::order_moves(move_array_t &moves, uint32_t i) {
     // selection sort is O(n^2) but becomes O(n) with beta cutoff
     // inspired by https://rustic-chess.org/search/ordering/how.html
     for (uint32_t j = i + 1; j < moves.size; j++) {
-        if (scores[j] > scores[i]) {
+        if (moves[j].score > moves[i].score) {
             std::swap(moves[j], moves[i]);
-            std::swap(scores[j], scores[i]);
         }
     }
     return moves[i];
 }
 
-int32_t chess_t::negamax(uint32_t depth, uint64_t max_nodes, bool root, int32_t alpha, int32_t beta) {
+int32_t chess_t::score_move(move_t move, uint32_t ply) {
+    if (move.is_capture() || move.is_promotion()) {
+        piece_t piece_start = board.get_piece(move.from).piece;
+        piece_t piece_end = board.get_piece(move.to).piece;
+        return capture_move_score + data::mvv_lva[piece_end][piece_start];
+    }
+    move_t (&killers)[2] = search_stack[ply].killers;
+    if (move == killers[0]) {
+        return killer_move_score;
+    }
+    if (move == killers[1]) {
+        return killer_move_score - 1;
+    }
+    return history[board.game_state_stack.last()->to_move][move.from][move.to];
+}
+
+void chess_t::update_quiet_history(move_t cutoff_move, uint32_t depth, uint32_t ply) {
+    search_ply_t &ss = search_stack[ply];
+    if (cutoff_move != ss.killers[0]) {
+        ss.killers[1] = ss.killers[0];
+        ss.killers[0] = cutoff_move;
+    }
+
+    // history gravity from https://www.chessprogramming.org/History_Heuristic,
+    // scaling each update by the distance to the limit keeps scores within +-max_history
+    color_t to_move = board.game_state_stack.last()->to_move;
+    int32_t bonus = (int32_t)std::min(depth * depth, (uint32_t)max_history);
+    for (move_t move : ss.searched_quiets) {
+        // quiet moves searched before the cutoff move failed low, so they are penalized
+        int32_t update = move == cutoff_move ? bonus : -bonus;
+        int32_t &entry = history[to_move][move.from][move.to];
+        entry += update - entry * abs(update) / max_history;
+    }
+}
+
+chess_t::move_t chess_t::move_picker_t::next() {
+    move_t move = next_staged();
+    if (excluded_moves) {
+        while (move.pack() != 0 && std::find(excluded_moves->begin(), excluded_moves->end(), move) != excluded_moves->end()) {
+            move = next_staged();
+        }
+    }
+    return move;
+}
+
+chess_t::move_t chess_t::move_picker_t::next_staged() {
+    constexpr move_t null_move = { 0, 0, move_t::QUIET };
+    switch (stage) {
+    case HASH_MOVE:
+        stage = GEN_CAPTURES;
+        if (hash_move != null_move) {
+            return hash_move;
+        }
+        [[fallthrough]];
+    case GEN_CAPTURES:
+        chess.gen_moves<chess_t::CAPTURES>(ss.moves);
+        for (uint32_t i = 0; i < ss.moves.size; i++) {
+            ss.moves[i].score = chess.score_move(ss.moves[i], ply);
+        }
+        idx = 0;
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
+    case GOOD_CAPTURES:
+        while (idx < ss.moves.size) {
+            move_t move = chess.order_moves(ss.moves, idx++);
+            if (move == hash_move) {
+                continue;
+            }
+            if (chess.is_losing_capture(move)) {
+                ss.bad_captures.add(move);
+                continue;
+            }
+            return move;
+        }
+        idx = 0;
+        stage = KILLERS;
+        [[fallthrough]];
+    case KILLERS:
+        // killers come from other positions at the same ply, so they have to be validated
+        while (idx < 2) {
+            move_t killer = ss.killers[idx++];
+            if (killer != null_move && killer != hash_move && chess.is_pseudo_legal(killer) && chess.is_legal(killer)) {
+                return killer;
+            }
+        }
+        stage = GEN_QUIETS;
+        [[fallthrough]];
+    case GEN_QUIETS:
+        chess.gen_moves<chess_t::QUIETS>(ss.moves);
+        for (uint32_t i = 0; i < ss.moves.size; i++) {
+            ss.moves[i].score = chess.score_move(ss.moves[i], ply);
+        }
+        idx = 0;
+        stage = QUIETS;
+        [[fallthrough]];
+    case QUIETS:
+        while (idx < ss.moves.size) {
+            move_t move = chess.order_moves(ss.moves, idx++);
+            if (move != hash_move && move != ss.killers[0] && move != ss.killers[1]) {
+                return move;
+            }
+        }
+        idx = 0;
+        stage = BAD_CAPTURES;
+        [[fallthrough]];
+    case BAD_CAPTURES:
+        // already in MVV-LVA order
+        if (idx < ss.bad_captures.size) {
+            return ss.bad_captures[idx++];
+        }
+        stage = DONE;
+        [[fallthrough]];
+    case DONE:
+        break;
+    }
+    return null_move;
+}
+
+int32_t chess_t::quiesce(int32_t alpha, int32_t beta) {
+    if (!searching) {
+        return 0;
+    }
+
+    uint32_t ply = board.game_state_stack.size - root_ply;
+    if (ply >= max_search_ply) {
+        return eval();
+    }
+    search_ply_t &ss = search_stack[ply];
+    move_array_t &moves = ss.moves;
+
+    // captures cannot repeat a position, so only checkmate needs to be detected
+    bool in_check = gen_attackers(intrin::ctz(board.bitboards[board.game_state_stack.last()->to_move][KING]), gen_blockers());
+
+    int32_t best_eval = eval_min;
+    ss.static_eval = eval_min;
+    if (in_check) {
+        // all evasions must be searched and standing pat is not allowed when in check
+        gen_moves(moves);
+        if (moves.size == 0) {
+            return eval_min;
+        }
+    } else {
+        // stand pat: assume a quiet move exists that is at least as good as the static evaluation
+        // only the stand pat bound matters here, so the piece terms are skipped far outside the window
+        best_eval = ss.static_eval = eval(alpha, beta);
+        if (best_eval >= beta) {
+            return best_eval;
+        }
+        // delta pruning: even winning a queen cannot raise alpha
+        if (best_eval + data::piece_values[QUEEN] + delta_pruning_margin < alpha) {
+            return best_eval;
+        }
+        alpha = std::max(alpha, best_eval);
+        gen_moves<CAPTURES>(moves);
+    }
+
+    for (uint32_t i = 0; i < moves.size; i++) {
+        move_t move = moves[i];
+        piece_t piece_start = board.get_piece(move.from).piece;
+        piece_t piece_end = board.get_piece(move.to).piece;
+        moves[i].score = data::mvv_lva[piece_end][piece_start];
+    }
+
+    for (uint32_t i = 0; i < moves.size; i++) {
+        move_t move = order_moves(moves, i);
+
+        // delta pruning: skip captures that cannot raise alpha even with a margin for positional gains
+        // the target square of an en passant capture is empty, the pawn taken is beside it
+        piece_t captured = move.flags == move_t::EN_PASSANT_CAPTURE ? PAWN : board.get_piece(move.to).piece;
+        if (!in_check && !move.is_promotion() &&
+            best_eval + data::piece_values[captured] + delta_pruning_margin < alpha) {
+            continue;
+        }
+        // captures losing material are unlikely to raise alpha
+        if (!in_check && is_losing_capture(move)) {
+            stats.see_prunes++;
+            continue;
+        }
+
+        count_node();
+        stats.qnodes++;
+
+        board.make_move(move);
+        int32_t move_eval = -quiesce(-beta, -alpha);
+        board.undo_move(move);
+
+        best_eval = std::max(best_eval, move_eval);
+        alpha = std::max(alpha, move_eval);
+        if (alpha >= beta) {
+            break; // beta cutoff
+        }
+    }
+    return best_eval;
+}
+
+bool chess_t::has_non_pawn_material() {
+    color_t to_move = board.game_state_stack.last()->to_move;
+    return board.bitboards[to_move][KNIGHT] | board.bitboards[to_move][BISHOP] | board.bitboards[to_move][ROOK] | board.bitboards[to_move][QUEEN];
+}
+
+void chess_t::update_pv(move_t move, uint32_t ply) {
+    search_ply_t &ss = search_stack[ply];
+    search_ply_t &child = search_stack[ply + 1];
+    ss.pv[0] = move;
+    std::copy(child.pv, child.pv + child.pv_length, ss.pv + 1);
+    ss.pv_length = child.pv_length + 1;
+}
+
+void chess_t::print_pv(pv_line_t &line) {
+    // checkmate and stalemate have no line to print
+    if (line.length > 0) {
+        print_uci(" pv");
+    }
+    for (uint32_t i = 0; i < line.length; i++) {
+        print_uci(" ");
+        line.moves[i].print();
+        line.moves[i].print(log);
+    }
+}
+
+int32_t chess_t::negamax(uint32_t depth, uint64_t max_nodes, bool root, int32_t alpha, int32_t beta, bool allow_null_move) {
     if (!searching) {
         return 0;
     }
 
+    // nodes that return without searching moves end the principal variation
+    uint32_t ply = board.game_state_stack.size - root_ply;
+    search_ply_t &ss = search_stack[ply];
+    ss.pv_length = 0;
+
     // lookup in transposition table and return if entry matches constraints
     uint64_t zobrist_key = board.game_state_stack.last()->zobrist_key;
-    transposition_table_t::transposition_entry_t entry = transposition_table.lookup(zobrist_key);
-    
-    bool entry_valid = entry.data_xor_key == ((uint64_t)entry.data ^ zobrist_key);
+    transposition_table_t::transposition_data_t entry;
+    bool entry_valid = transposition_table.lookup(zobrist_key, entry);
+    stats.tt_probes++;
+    stats.tt_hits += entry_valid;
 
-    // TODO: add return move at root along with a move validity check
-    if (entry_valid && entry.data.depth >= depth && !root) {
-        switch (entry.data.type) {
+    // the root always searches its moves so that it produces a best move and a principal variation, and other
+    // nodes inside the window do too so that a cutoff does not cut the principal variation short
+    bool pv_node = (int64_t)beta - alpha > 1;
+    if (entry_valid && entry.depth >= depth && !root && !pv_node) {
+        switch (entry.type) {
         case transposition_table_t::EXACT:
-            return entry.data.eval;
+            return entry.eval;
         case transposition_table_t::UPPERBOUND:
-            if (entry.data.eval <= alpha) {
-                return entry.data.eval;
+            if (entry.eval <= alpha) {
+                return entry.eval;
             }
             break;
         case transposition_table_t::LOWERBOUND:
-            if (entry.data.eval >= beta) {
-                return entry.data.eval;
+            if (entry.eval >= beta) {
+                return entry.eval;
             }
             break;
         }
     }
 
-    // TODO: search transposition table entry first without involving move ordering
-    move_array_t moves = gen_moves();
-
-    if (moves.size == 0) {
-        if (gen_attackers(intrin::ctz(board.bitboards[board.game_state_stack.last()->to_move][KING]), gen_blockers())) {
-            return eval_min;
-        }
+    if (is_repetition() || is_insufficient_material()) {
         return 0;
     }
 
-    if (is_repetition() || is_insufficient_material() || is_fifty_move_rule()) {
-        return 0;
+    if (ply >= max_search_ply) {
+        return eval();
     }
 
     if (depth == 0) {
-        return eval();
+        return quiesce(alpha, beta);
     }
 
-    // should use a VLA (uint8_t scores[moves.size]) but removed in C++
-    uint8_t scores[max_moves];
+    move_t hash_move = move_t::unpack(entry.move);
+    bool hash_move_valid = entry_valid && is_pseudo_legal(hash_move) && is_legal(hash_move);
 
-    for (uint32_t i = 0; i < moves.size; i++) {
-        move_t move = moves[i];
-        piece_t piece_start = board.get_piece(move.from).piece;
-        piece_t piece_end = board.get_piece(move.to).piece;
-        scores[i] = data::mvv_lva[piece_end][piece_start];
+    // along the previous iteration's principal variation, its move is searched first even if the table lost it
+    if (root) {
+        follow_pv = true;
     }
-    
-    // search transposition table entry first (if it exists)
-    if (entry_valid) {
-        scores[entry.data.move_idx] = transposition_table_move_score;
+    pv_line_t &root_pv = pv_lines[pv_idx];
+    bool on_pv = follow_pv && ply < root_pv.length;
+    follow_pv = false;
+    move_t pv_move = on_pv ? root_pv.moves[ply] : move_t::unpack(0);
+    if (on_pv && (!hash_move_valid || hash_move != pv_move) && is_pseudo_legal(pv_move) && is_legal(pv_move)) {
+        hash_move = pv_move;
+        hash_move_valid = true;
+    }
+
+    // checkmate takes precedence over the fifty move rule, so it only applies if there is a legal move
+    if (is_fifty_move_rule()) {
+        if (!hash_move_valid) {
+            gen_moves(ss.moves);
+        }
+        if (hash_move_valid || ss.moves.size) {
+            return 0;
+        }
+    }
+
+    color_t to_move = board.game_state_stack.last()->to_move;
+    bool in_check = gen_attackers(intrin::ctz(board.bitboards[to_move][KING]), gen_blockers());
+
+    // null move pruning: if passing the turn still fails high, a real move almost certainly would too
+    // disabled in pawn endings, where zugzwang makes passing better than any move
+    bool try_null_move = allow_null_move && !root && depth >= null_move_min_depth && !in_check &&
+                         beta != eval_max && has_non_pawn_material();
+    // the static eval is only read here, so nodes that cannot try a null move skip it
+    ss.static_eval = try_null_move ? eval() : eval_min;
+    if (try_null_move && ss.static_eval >= beta) {
+        uint32_t reduction = 2 + depth / 6;
+
+        board.make_null_move();
+        count_node();
+        int32_t null_eval = -negamax(depth - 1 - reduction, max_nodes, false, -beta, -beta + 1, false);
+        board.undo_null_move();
+
+        if (!searching) {
+            return 0;
+        }
+        // the verification search confirms the cutoff with a reduced search of real moves
+        if (null_eval >= beta &&
+            (!null_move_verification || negamax(depth - reduction, max_nodes, false, beta - 1, beta, false) >= beta)) {
+            stats.null_move_cutoffs++;
+            return beta;
+        }
     }
 
+    // the hash move is searched before any moves are generated, so a cutoff skips move generation entirely
+    move_picker_t move_picker(*this, hash_move_valid ? hash_move : move_t::unpack(0), ply, root ? &excluded_root_moves : nullptr);
+    ss.searched_quiets.size = 0;
+
     int32_t best_eval = eval_min;
-    uint8_t move_idx = 0;
+    move_t node_best_move = move_t::unpack(0);
     
     int32_t original_alpha = alpha;
 
-    for (uint32_t i = 0; i < moves.size; i++, nodes++) {
-
-        move_t move = order_moves(moves, scores, i);
-        
+    uint32_t i = 0;
+    for (move_t move = move_picker.next(); move.pack() != 0; move = move_picker.next(), i++, count_node()) {
+        follow_pv = on_pv && move == pv_move;
         board.make_move(move);
-        int32_t move_eval = -negamax(depth - 1, max_nodes, false, -beta, -alpha);
+        int32_t move_eval;
+        // principal variation search: assume the first move is best and prove the rest are worse with a null window
+        if (i == 0) {
+            move_eval = -negamax(depth - 1, max_nodes, false, -beta, -alpha);
+        } else {
+            // late move reductions: late quiet moves and losing captures are unlikely to be best, so search them shallower first
+            uint32_t reduction = 0;
+            bool reducible = (!move.is_capture() && !move.is_promotion()) || move_picker.stage == move_picker_t::BAD_CAPTURES;
+            if (depth >= lmr_min_depth && i >= lmr_min_move && !in_check && reducible &&
+                !gen_attackers(intrin::ctz(board.bitboards[!to_move][KING]), gen_blockers())) {
+                reduction = lmr_reductions[std::min(depth, lmr_max_idx - 1)][std::min(i, lmr_max_idx - 1)];
+            }
+            move_eval = -negamax(depth - 1 - reduction, max_nodes, false, -alpha - 1, -alpha);
+            if (reduction && move_eval > alpha) {
+                move_eval = -negamax(depth - 1, max_nodes, false, -alpha - 1, -alpha);
+            }
+            if (move_eval > alpha && move_eval < beta) {
+                move_eval = -negamax(depth - 1, max_nodes, false, -beta, -alpha);
+            }
+        }
         board.undo_move(move);
 
         if (move_eval > best_eval) {
             best_eval = move_eval;
-            move_idx = i;
+            node_best_move = move;
             if (root) {
                 best_move = move;
             }
         }
+        if (move_eval > alpha) {
+            update_pv(move, ply);
+        }
 
-        if (!searching || nodes >= max_nodes) {
+        if (!searching || node_limit_reached(max_nodes)) {
             return best_eval;
         }
 
+        bool quiet = !move.is_capture() && !move.is_promotion();
+        if (quiet) {
+            ss.searched_quiets.add(move);
+        }
+
         alpha = std::max(alpha, move_eval);
         if (alpha >= beta) {
+            stats.beta_cutoffs++;
+            stats.first_move_cutoffs += i == 0;
+            if (quiet) {
+                update_quiet_history(move, depth, ply);
+            }
             break; // beta cutoff
         }
     }
-    transposition_table.store(best_eval, move_idx, zobrist_key, original_alpha, beta, depth);
+
+    // a cutoff breaks out of the loop before i is incremented, but always raises best_eval above eval_min
+    if (i == 0 && best_eval == eval_min) {
+        return in_check ? eval_min : 0; // checkmate or stalemate
+    }
+    // with excluded root moves the result is not the root position's value
+    if (root && excluded_root_moves.size) {
+        return best_eval;
+    }
+    stats.tt_stores++;
+    stats.tt_overwrites += transposition_table.store(best_eval, node_best_move.pack(), zobrist_key, original_alpha, beta, depth);
     return best_eval;
 }
 
-int32_t chess_t::search(uint32_t max_depth, uint64_t max_nodes, bool use_opening_book) {
-    searching = true;
+int32_t chess_t::aspiration_search(uint32_t depth, uint64_t max_nodes, int32_t previous_eval) {
+    if (depth < aspiration_min_depth) {
+        return negamax(depth, max_nodes);
+    }
+    // search a window around the previous iteration's eval, widening it exponentially on the failing side
+    int64_t delta = aspiration_window;
+    int32_t alpha = (int32_t)std::max<int64_t>((int64_t)previous_eval - delta, eval_min);
+    int32_t beta = (int32_t)std::min<int64_t>((int64_t)previous_eval + delta, eval_max);
+    while (true) {
+        int32_t eval = negamax(depth, max_nodes, true, alpha, beta);
+        if (!searching || node_limit_reached(max_nodes)) {
+            return eval;
+        }
+        delta *= 2;
+        if (eval <= alpha && alpha != eval_min) {
+            alpha = (int32_t)std::max<int64_t>((int64_t)eval - delta, eval_min);
+        } else if (eval >= beta && beta != eval_max) {
+            beta = (int32_t)std::min<int64_t>((int64_t)eval + delta, eval_max);
+        } else {
+            return eval;
+        }
+    }
+}
+
+void chess_t::new_search() {
     nodes = 0;
+    best_move = move_t::unpack(0);
+    stats = {};
+    root_ply = board.game_state_stack.size;
+    pv_idx = 0;
+    excluded_root_moves.size = 0;
+    for (pv_line_t &line : pv_lines) {
+        line.eval = 0;
+        line.length = 0;
+    }
+    for (uint32_t ply = 0; ply <= max_search_ply; ply++) {
+        search_ply_t &ss = search_stack[ply];
+        ss.killers[0] = ss.killers[1] = move_t::unpack(0);
+    }
+    // keep move ordering information from earlier searches but let recent cutoffs dominate
+    for (auto &color_history : history) {
+        for (auto &from_history : color_history) {
+            for (int32_t &entry : from_history) {
+                entry /= 2;
+            }
+        }
+    }
+}
+
+int32_t chess_t::search(uint32_t max_depth, uint64_t max_nodes, bool use_opening_book) {
+    new_search();
     if (use_opening_book && board.game_state_stack.size < 10) {
         if (opening_book.lookup(board, best_move)) {
             print_uci("info depth 0 nodes 0 score cp 0 time 0 nps 0 multipv 1 pv ");
@@ -122,39 +490,143 @@ int32_t chess_t::search(uint32_t max_depth, uint64_t max_nodes, bool use_opening
             return 0;
         }
     }
+
+    transposition_table.new_search();
+
+    // Lazy SMP: helpers search copies of the board and communicate only through the shared transposition table
+    for (uint32_t i = 0; i < helpers.size(); i++) {
+        chess_t *helper = helpers[i].get();
+        helper->board = board;
+        helper->new_search();
+        helper->searching = true;
+        helper->worker.run([helper, i, max_depth, max_nodes] { helper->search_helper(i, max_depth, max_nodes); });
+    }
+
     // TODO: use partial search results
-    int32_t eval;
+    int32_t eval = 0;
+    uint32_t lines = std::max(1u, std::min(multi_pv, gen_moves().size));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     for (uint32_t depth = 1; depth < max_depth; depth++) {
         move_t old_best_move = best_move;
-        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-        eval = negamax(depth, max_nodes);
+        excluded_root_moves.size = 0;
+        for (pv_idx = 0; pv_idx < lines; pv_idx++) {
+            pv_line_t &line = pv_lines[pv_idx];
+            int32_t line_eval = aspiration_search(depth, max_nodes, line.eval);
+            if (!searching || node_limit_reached(max_nodes)) {
+                break;
+            }
+            // the principal variation always starts with the best move, even when a draw by repetition cuts it short
+            search_ply_t &root_ss = search_stack[0];
+            if (best_move == move_t::unpack(0)) {
+                root_ss.pv_length = 0; // checkmate or stalemate
+            } else if (root_ss.pv_length == 0 || root_ss.pv[0] != best_move) {
+                root_ss.pv[0] = best_move;
+                root_ss.pv_length = 1;
+            }
+            line.eval = line_eval;
+            line.length = root_ss.pv_length;
+            std::copy(root_ss.pv, root_ss.pv + root_ss.pv_length, line.moves);
+            excluded_root_moves.add(best_move);
+        }
+        pv_idx = 0;
+        excluded_root_moves.size = 0;
         std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-        if (!searching || nodes >= max_nodes) {
+        if (!searching || node_limit_reached(max_nodes)) {
             best_move = old_best_move;
             break;
         }
+        // later lines can score above earlier ones after the search is re-run with a different window
+        std::stable_sort(pv_lines, pv_lines + lines, [](const pv_line_t &a, const pv_line_t &b) { return a.eval > b.eval; });
+        best_move = pv_lines[0].length > 0 ? pv_lines[0].moves[0] : move_t::unpack(0);
+        eval = pv_lines[0].eval;
+
         std::chrono::duration<float> time = end - start;
+        uint64_t total_nodes = count_nodes();
 
-        print_uci("info depth %u nodes %llu score cp %d time %lli nps %llu multipv 1 pv ",
-                   depth, nodes, eval, std::chrono::duration_cast<std::chrono::milliseconds>(time).count(), (uint64_t)(nodes / time.count()));
-        best_move.print();
-        best_move.print(log);
-        print_uci("\n");
+        for (uint32_t i = 0; i < lines; i++) {
+            print_uci("info depth %u nodes %llu score cp %d time %lli nps %llu hashfull %u multipv %u",
+                       depth, total_nodes, pv_lines[i].eval, std::chrono::duration_cast<std::chrono::milliseconds>(time).count(), (uint64_t)(total_nodes / time.count()),
+                       transposition_table.hashfull(), i + 1);
+            print_pv(pv_lines[i]);
+            print_uci("\n");
+        }
     }
     stop_search();
+    for (std::unique_ptr<chess_t> &helper : helpers) {
+        helper->worker.wait();
+    }
     return eval;
 
 }
 
+void chess_t::search_helper(uint32_t thread_idx, uint32_t max_depth, uint64_t max_nodes) {
+    // stagger start depths so helpers do not search the same depth as the main thread in lockstep
+    int32_t eval = 0;
+    for (uint32_t depth = 1 + (thread_idx + 1) % 2; depth < max_depth && searching && !node_limit_reached(max_nodes); depth++) {
+        eval = aspiration_search(depth, max_nodes, eval);
+    }
+}
+
+void chess_t::set_threads(uint32_t threads) {
+    // destroying a helper joins its worker thread
+    helpers.clear();
+    for (uint32_t i = 1; i < threads; i++) {
+        helpers.push_back(std::make_unique<chess_t>(*this));
+    }
+}
+
+bool chess_t::node_limit_reached(uint64_t max_nodes) {
+    // the limit is on the nodes of all threads, which the main thread counts for its helpers
+    return max_nodes != UINT64_MAX && (main_thread ? main_thread->count_nodes() : count_nodes()) >= max_nodes;
+}
+
+uint64_t chess_t::count_nodes() {
+    uint64_t total_nodes = nodes;
+    for (std::unique_ptr<chess_t> &helper : helpers) {
+        total_nodes += helper->nodes;
+    }
+    return total_nodes;
+}
+
 int32_t chess_t::search_timed(std::chrono::milliseconds time, uint32_t max_depth, uint64_t max_nodes, bool use_opening_book) {
-    std::future<int32_t> eval = std::async(std::launch::async, &chess_t::search, this, max_depth, max_nodes, use_opening_book);
-    std::future_status status = eval.wait_for(time);
-    if (status == std::future_status::timeout) {
-        stop_search();
+    timer->run([this, time] {
+        std::unique_lock<std::mutex> lock(search_mutex);
+        // the clock starts on ponderhit
+        search_cv.wait(lock, [this] { return !pondering || !searching; });
+        // go depth and go nodes have no clock and only end on their own limits or on stop
+        if (time == (std::chrono::milliseconds)0) {
+            search_cv.wait(lock, [this] { return !searching; });
+        } else if (!search_cv.wait_for(lock, time, [this] { return !searching; })) {
+            lock.unlock();
+            stop_search();
+        }
+    });
+    int32_t eval = search(max_depth, max_nodes, use_opening_book);
+    // search() ends with stop_search(), which wakes the timer if the deadline has not passed
+    timer->wait();
+    return eval;
+}
+
+chess_t::search_stats_t chess_t::count_stats() {
+    search_stats_t total_stats = stats;
+    for (std::unique_ptr<chess_t> &helper : helpers) {
+        total_stats += helper->stats;
     }
-    return eval.get();
+    return total_stats;
 }
 
 void chess_t::stop_search() {
     searching = false;
+    for (std::unique_ptr<chess_t> &helper : helpers) {
+        helper->searching = false;
+    }
+    notify_search();
+}
+
+void chess_t::notify_search() {
+    // taking the lock orders the change before a waiter's predicate check, so the notification cannot be missed
+    {
+        std::lock_guard<std::mutex> lock(search_mutex);
+    }
+    search_cv.notify_all();
 }
@@ -0,0 +1,75 @@
+#include "chess.h"
+#include "data.h"
+
+int32_t chess_t::see(move_t move) {
+    // swap algorithm from https://www.chessprogramming.org/SEE_-_The_Swap_Algorithm
+    // pins are ignored, so a pinned piece may still take part in the exchange
+    color_t to_move = board.game_state_stack.last()->to_move;
+    color_t side = to_move;
+    square_t square = move.to;
+
+    uint64_t colors[2];
+    for (uint32_t color = WHITE; color <= BLACK; color++) {
+        colors[color] = board.bitboards[color][PAWN] | board.bitboards[color][KNIGHT] | board.bitboards[color][BISHOP] | board.bitboards[color][ROOK] | board.bitboards[color][QUEEN] | board.bitboards[color][KING];
+    }
+    uint64_t bishop_queen = board.bitboards[WHITE][BISHOP] | board.bitboards[BLACK][BISHOP] | board.bitboards[WHITE][QUEEN] | board.bitboards[BLACK][QUEEN];
+    uint64_t rook_queen = board.bitboards[WHITE][ROOK] | board.bitboards[BLACK][ROOK] | board.bitboards[WHITE][QUEEN] | board.bitboards[BLACK][QUEEN];
+    uint64_t blockers = colors[WHITE] | colors[BLACK];
+
+    // gain[d] is the speculative material balance after the d-th capture, from the capturing side's view
+    int32_t gain[32];
+    uint32_t d = 0;
+    piece_t attacker = board.get_piece(move.from).piece;
+    gain[0] = data::piece_values[board.get_piece(square).piece];
+    if (move.flags == move_t::EN_PASSANT_CAPTURE) {
+        gain[0] = data::piece_values[PAWN];
+        blockers ^= 1ull << (square + (to_move == WHITE ? 8 : -8));
+    }
+    if (move.is_promotion()) {
+        attacker = move.get_promotion();
+        gain[0] += data::piece_values[attacker] - data::piece_values[PAWN];
+    }
+
+    uint64_t from_bitboard = 1ull << move.from;
+    uint64_t attackers = gen_all_attackers(square, blockers);
+    do {
+        d++;
+        side = (color_t)!side;
+        gain[d] = data::piece_values[attacker] - gain[d - 1];
+        // neither side can improve by continuing the exchange
+        if (std::max(-gain[d - 1], gain[d]) < 0) {
+            break;
+        }
+        blockers ^= from_bitboard;
+        // removing the capturing piece can uncover an x-ray attacker behind it
+        attackers |= gen_bishop_moves(square, blockers, 0ull) & bishop_queen;
+        attackers |= gen_rook_moves(square, blockers, 0ull) & rook_queen;
+        attackers &= blockers;
+
+        uint64_t side_attackers = attackers & colors[side];
+        from_bitboard = 0ull;
+        if (side_attackers) {
+            // least valuable attacker
+            for (attacker = PAWN; !(side_attackers & board.bitboards[side][attacker]); attacker = (piece_t)(attacker + 1));
+            // the king cannot capture onto a defended square
+            if (attacker != KING || !(attackers & colors[!side])) {
+                from_bitboard = intrin::blsi(side_attackers & board.bitboards[side][attacker]);
+            }
+        }
+    } while (from_bitboard);
+
+    // the final speculative capture never happens, each side may stop capturing if it would lose material
+    while (--d) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+    return gain[0];
+}
+
+bool chess_t::is_losing_capture(move_t move) {
+    // legal king captures and captures of a more valuable piece cannot lose material
+    piece_t piece_start = board.get_piece(move.from).piece;
+    if (!move.is_promotion() && data::piece_values[board.get_piece(move.to).piece] >= data::piece_values[piece_start]) {
+        return false;
+    }
+    return see(move) < 0;
+}
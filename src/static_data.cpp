@@ -111,6 +111,21 @@ const perft_result_t perft_results[] = {
         },
     },
 };
+// middlegame and endgame positions from Stockfish's bench
+const char *const bench_fens[] = {
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+};
 const char piece_to_char[][7] = {
     {
         'P',
@@ -131,59 +146,162 @@ const char piece_to_char[][7] = {
         '.',
     },
 };
-// combined from https://www.chessprogramming.org/Simplified_Evaluation_Function
-const int16_t piece_square_values[][64] = {
-    {
-        100, 100, 100, 100, 100, 100, 100, 100,
-        150, 150, 150, 150, 150, 150, 150, 150,
-        110, 110, 120, 130, 130, 120, 110, 110,
-        105, 105, 110, 125, 125, 110, 105, 105,
-        100, 100, 100, 120, 120, 100, 100, 100,
-        105,  95,  90, 100, 100,  90,  95, 105,
-        105, 110, 110,  80,  80, 110, 110, 105,
-        100, 100, 100, 100, 100, 100, 100, 100,
-    },
-    {
-        270, 280, 290, 290, 290, 290, 280, 270,
-        280, 300, 320, 320, 320, 320, 300, 280,
-        290, 320, 330, 335, 335, 330, 320, 290,
-        290, 325, 335, 340, 340, 335, 325, 290,
-        290, 320, 335, 340, 340, 335, 320, 290,
-        290, 325, 330, 335, 335, 330, 325, 290,
-        280, 300, 320, 325, 325, 320, 300, 280,
-        270, 280, 290, 290, 290, 290, 280, 270,
-    },
-    {
-        310, 320, 320, 320, 320, 320, 320, 310,
-        320, 330, 330, 330, 330, 330, 330, 320,
-        320, 330, 335, 340, 340, 335, 330, 320,
-        320, 335, 335, 340, 340, 335, 335, 320,
-        320, 330, 340, 340, 340, 340, 330, 320,
-        320, 340, 340, 340, 340, 340, 340, 320,
-        320, 335, 330, 330, 330, 330, 335, 320,
-        310, 320, 320, 320, 320, 320, 320, 310,
-    },
-    {
-        500, 500, 500, 500, 500, 500, 500, 500,
-        505, 510, 510, 510, 510, 510, 510, 505,
-        495, 500, 500, 500, 500, 500, 500, 495,
-        495, 500, 500, 500, 500, 500, 500, 495,
-        495, 500, 500, 500, 500, 500, 500, 495,
-        495, 500, 500, 500, 500, 500, 500, 495,
-        495, 500, 500, 500, 500, 500, 500, 495,
-        500, 500, 500, 505, 505, 500, 500, 500,
-    },
-    {
-        880, 890, 890, 895, 895, 890, 890, 880,
-        890, 900, 900, 900, 900, 900, 900, 890,
-        890, 900, 905, 905, 905, 905, 900, 890,
-        895, 900, 905, 905, 905, 905, 900, 895,
-        900, 900, 905, 905, 905, 905, 900, 895,
-        890, 905, 905, 905, 905, 905, 900, 890,
-        890, 900, 905, 900, 900, 900, 900, 890,
-        880, 890, 890, 895, 895, 890, 890, 880,
+// combined from https://www.chessprogramming.org/Simplified_Evaluation_Function by tools/psqt.py
+const int16_t piece_square_values[][6][64] = {
+    // middlegame
+    {
+        {
+            100, 100, 100, 100, 100, 100, 100, 100,
+            150, 150, 150, 150, 150, 150, 150, 150,
+            110, 110, 120, 130, 130, 120, 110, 110,
+            105, 105, 110, 125, 125, 110, 105, 105,
+            100, 100, 100, 120, 120, 100, 100, 100,
+            105,  95,  90, 100, 100,  90,  95, 105,
+            105, 110, 110,  80,  80, 110, 110, 105,
+            100, 100, 100, 100, 100, 100, 100, 100,
+        },
+        {
+            270, 280, 290, 290, 290, 290, 280, 270,
+            280, 300, 320, 320, 320, 320, 300, 280,
+            290, 320, 330, 335, 335, 330, 320, 290,
+            290, 325, 335, 340, 340, 335, 325, 290,
+            290, 320, 335, 340, 340, 335, 320, 290,
+            290, 325, 330, 335, 335, 330, 325, 290,
+            280, 300, 320, 325, 325, 320, 300, 280,
+            270, 280, 290, 290, 290, 290, 280, 270,
+        },
+        {
+            310, 320, 320, 320, 320, 320, 320, 310,
+            320, 330, 330, 330, 330, 330, 330, 320,
+            320, 330, 335, 340, 340, 335, 330, 320,
+            320, 335, 335, 340, 340, 335, 335, 320,
+            320, 330, 340, 340, 340, 340, 330, 320,
+            320, 340, 340, 340, 340, 340, 340, 320,
+            320, 335, 330, 330, 330, 330, 335, 320,
+            310, 320, 320, 320, 320, 320, 320, 310,
+        },
+        {
+            500, 500, 500, 500, 500, 500, 500, 500,
+            505, 510, 510, 510, 510, 510, 510, 505,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            500, 500, 500, 505, 505, 500, 500, 500,
+        },
+        {
+            880, 890, 890, 895, 895, 890, 890, 880,
+            890, 900, 900, 900, 900, 900, 900, 890,
+            890, 900, 905, 905, 905, 905, 900, 890,
+            895, 900, 905, 905, 905, 905, 900, 895,
+            900, 900, 905, 905, 905, 905, 900, 895,
+            890, 905, 905, 905, 905, 905, 900, 890,
+            890, 900, 905, 900, 900, 900, 900, 890,
+            880, 890, 890, 895, 895, 890, 890, 880,
+        },
+        {
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -30, -40, -40, -50, -50, -40, -40, -30,
+            -20, -30, -30, -40, -40, -30, -30, -20,
+            -10, -20, -20, -20, -20, -20, -20, -10,
+             20,  20,   0,   0,   0,   0,  20,  20,
+             20,  30,  10,   0,   0,  10,  30,  20,
+        },
+    },
+    // endgame
+    {
+        {
+            100, 100, 100, 100, 100, 100, 100, 100,
+            150, 150, 150, 150, 150, 150, 150, 150,
+            110, 110, 120, 130, 130, 120, 110, 110,
+            105, 105, 110, 125, 125, 110, 105, 105,
+            100, 100, 100, 120, 120, 100, 100, 100,
+            105,  95,  90, 100, 100,  90,  95, 105,
+            105, 110, 110,  80,  80, 110, 110, 105,
+            100, 100, 100, 100, 100, 100, 100, 100,
+        },
+        {
+            270, 280, 290, 290, 290, 290, 280, 270,
+            280, 300, 320, 320, 320, 320, 300, 280,
+            290, 320, 330, 335, 335, 330, 320, 290,
+            290, 325, 335, 340, 340, 335, 325, 290,
+            290, 320, 335, 340, 340, 335, 320, 290,
+            290, 325, 330, 335, 335, 330, 325, 290,
+            280, 300, 320, 325, 325, 320, 300, 280,
+            270, 280, 290, 290, 290, 290, 280, 270,
+        },
+        {
+            310, 320, 320, 320, 320, 320, 320, 310,
+            320, 330, 330, 330, 330, 330, 330, 320,
+            320, 330, 335, 340, 340, 335, 330, 320,
+            320, 335, 335, 340, 340, 335, 335, 320,
+            320, 330, 340, 340, 340, 340, 330, 320,
+            320, 340, 340, 340, 340, 340, 340, 320,
+            320, 335, 330, 330, 330, 330, 335, 320,
+            310, 320, 320, 320, 320, 320, 320, 310,
+        },
+        {
+            500, 500, 500, 500, 500, 500, 500, 500,
+            505, 510, 510, 510, 510, 510, 510, 505,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            495, 500, 500, 500, 500, 500, 500, 495,
+            500, 500, 500, 505, 505, 500, 500, 500,
+        },
+        {
+            880, 890, 890, 895, 895, 890, 890, 880,
+            890, 900, 900, 900, 900, 900, 900, 890,
+            890, 900, 905, 905, 905, 905, 900, 890,
+            895, 900, 905, 905, 905, 905, 900, 895,
+            900, 900, 905, 905, 905, 905, 900, 895,
+            890, 905, 905, 905, 905, 905, 900, 890,
+            890, 900, 905, 900, 900, 900, 900, 890,
+            880, 890, 890, 895, 895, 890, 890, 880,
+        },
+        {
+            -50, -40, -30, -20, -20, -30, -40, -50,
+            -30, -20, -10,   0,   0, -10, -20, -30,
+            -30, -10,  20,  30,  30,  20, -10, -30,
+            -30, -10,  30,  40,  40,  30, -10, -30,
+            -30, -10,  30,  40,  40,  30, -10, -30,
+            -30, -10,  20,  30,  30,  20, -10, -30,
+            -30, -30,   0,   0,   0,   0, -30, -30,
+            -50, -30, -30, -30, -30, -30, -30, -50,
+        },
     },
 };
+// material values used by tools/psqt.py and tools/mvv_lva.py
+const int32_t piece_values[] = {
+    100, 320, 330, 500, 900, 0, 0,
+};
+// game phase weights, the starting position has the full middlegame phase of 24
+const int32_t phase_values[] = {
+    0, 1, 1, 2, 4, 0, 0,
+};
+// pawn structure terms as [middlegame, endgame], passed pawns by rank counted from the pawn's own side
+const int16_t passed_pawn_values[][8] = {
+    { 0,  5,  5, 10, 20, 35,  60, 0, },
+    { 0, 10, 15, 25, 40, 65, 100, 0, },
+};
+// passed pawns that can advance because their stop square is empty
+const int16_t free_passed_pawn_values[] = { 0, 10, };
+const int16_t isolated_pawn_values[] = { -10, -15, };
+const int16_t doubled_pawn_values[] = { -10, -20, };
+const int16_t backward_pawn_values[] = { -8, -10, };
+// [middlegame, endgame] per attacked square outside the own pieces and the enemy pawn attacks
+const int16_t mobility_values[][6] = {
+    { 0, 4, 5, 2, 1, 0, },
+    { 0, 4, 5, 4, 2, 0, },
+};
+// attack units per square of the enemy king zone, from https://www.chessprogramming.org/King_Safety#Attack_Units
+const int32_t king_attack_weights[] = {
+    0, 2, 2, 3, 5, 0, 0,
+};
 // inspired by https://rustic-chess.org/search/ordering/mvv_lva.html
 const uint8_t mvv_lva[][6] = {
     { 15, 14, 13, 12, 11, 10, },
@@ -817,4 +935,106 @@ const insufficient_material_test_t insufficient_material_test_data[] = {
         false,
     },
 };
-}
\ No newline at end of file
+// expected values use piece_values (P 100, N 320, B 330, R 500, Q 900)
+const see_test_t see_test_data[] = {
+    {
+        // undefended pawn
+        "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1",
+        { chess_t::E1, chess_t::E5, chess_t::move_t::CAPTURE },
+        100,
+    },
+    {
+        // knight for pawn after a long exchange with x-rays behind the rook and bishop
+        "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1",
+        { chess_t::D3, chess_t::E5, chess_t::move_t::CAPTURE },
+        -220,
+    },
+    {
+        // pawn for pawn
+        "4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1",
+        { chess_t::E4, chess_t::D5, chess_t::move_t::CAPTURE },
+        0,
+    },
+    {
+        // queen takes defended pawn
+        "4k3/8/2p5/3p4/8/8/3Q4/4K3 w - - 0 1",
+        { chess_t::D2, chess_t::D5, chess_t::move_t::CAPTURE },
+        -800,
+    },
+    {
+        // knight takes defended pawn
+        "4k3/8/2p5/3p4/8/4N3/8/4K3 w - - 0 1",
+        { chess_t::E3, chess_t::D5, chess_t::move_t::CAPTURE },
+        -220,
+    },
+    {
+        // rook x-ray behind the capturing rook wins the exchange
+        "3r2k1/8/8/3p4/8/8/3R4/3RK3 w - - 0 1",
+        { chess_t::D2, chess_t::D5, chess_t::move_t::CAPTURE },
+        100,
+    },
+    {
+        // king cannot recapture a square defended by an x-ray
+        "8/8/3k4/3p4/8/8/3R4/3RK3 w - - 0 1",
+        { chess_t::D2, chess_t::D5, chess_t::move_t::CAPTURE },
+        100,
+    },
+    {
+        // king recaptures an undefended square
+        "8/8/3k4/3p4/8/8/3R4/4K3 w - - 0 1",
+        { chess_t::D2, chess_t::D5, chess_t::move_t::CAPTURE },
+        -400,
+    },
+    {
+        // en passant
+        "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1",
+        { chess_t::E5, chess_t::D6, chess_t::move_t::EN_PASSANT_CAPTURE },
+        100,
+    },
+    {
+        // promotion into a defended square
+        "2r1k3/1P6/8/8/8/8/8/4K3 w - - 0 1",
+        { chess_t::B7, chess_t::B8, chess_t::move_t::QUEEN_PROMOTION },
+        -100,
+    },
+    {
+        // capture promotion
+        "2r1k3/1P6/8/8/8/8/8/4K3 w - - 0 1",
+        { chess_t::B7, chess_t::C8, chess_t::move_t::QUEEN_PROMOTION_CAPTURE },
+        1300,
+    },
+    {
+        // black to move
+        "4k3/8/8/4p3/3P4/8/8/4K3 b - - 0 1",
+        { chess_t::E5, chess_t::D4, chess_t::move_t::CAPTURE },
+        100,
+    },
+};
+const pawn_structure_test_t pawn_structure_test_data[] = {
+    {
+        // lone pawn
+        "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1",
+        { 1ull << chess_t::E2, 0 },
+    },
+    {
+        // each pawn can be captured on its way by the other
+        "4k3/3p4/8/8/8/8/4P3/4K3 w - - 0 1",
+        { 0, 0 },
+    },
+    {
+        // pawns side by side have passed each other
+        "4k3/8/8/3pP3/8/8/8/4K3 w - - 0 1",
+        { 1ull << chess_t::E5, 1ull << chess_t::D5 },
+    },
+    {
+        // only the front pawn of doubled pawns is passed
+        "4k3/8/8/8/4P3/4P3/8/4K3 w - - 0 1",
+        { 1ull << chess_t::E4, 0 },
+    },
+    {
+        // blocked by a pawn on the same file
+        "4k3/8/4p3/8/4P3/8/8/4K3 w - - 0 1",
+        { 0, 0 },
+    },
+};
+}
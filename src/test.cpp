@@ -21,6 +21,79 @@ uint64_t chess_t::perft(uint32_t depth, bool root) {
     return num_moves;
 }
 
+template <typename visit_t>
+uint64_t chess_t::walk(uint32_t depth, visit_t &&visit) {
+    visit();
+    if (depth == 0) {
+        return 1;
+    }
+    uint64_t nodes = 1;
+    move_array_t moves = gen_moves();
+    for (move_t &move : moves) {
+        board.make_move(move);
+        nodes += walk(depth - 1, visit);
+        board.undo_move(move);
+    }
+    return nodes;
+}
+
+void chess_t::random_nnue(uint32_t seed) {
+    // small enough that the int32 output sum cannot overflow, wide enough that both ends of the clipped ReLU are hit
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int32_t> feature_weight(-48, 48);
+    std::uniform_int_distribution<int32_t> feature_bias(-64, 192);
+    std::uniform_int_distribution<int32_t> output_weight(-64, 64);
+    nnue_network = std::make_unique<nnue_network_t>();
+    for (auto &weights : nnue_network->feature_weights) {
+        for (int16_t &weight : weights) {
+            weight = (int16_t)feature_weight(rng);
+        }
+    }
+    for (int16_t &bias : nnue_network->feature_bias) {
+        bias = (int16_t)feature_bias(rng);
+    }
+    for (auto &weights : nnue_network->output_weights) {
+        for (int16_t &weight : weights) {
+            weight = (int16_t)output_weight(rng);
+        }
+    }
+    nnue_network->output_bias = (int16_t)output_weight(rng);
+}
+
+void chess_t::bench(uint32_t depth) {
+    // fixed-depth search over the perft and bench positions, run with different Threads values to measure scaling
+    uint64_t total_nodes = 0;
+    transposition_table.allocate();
+    transposition_table.clear();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        board.load_fen(perft_pos.fen);
+        searching = true;
+        search(depth, UINT64_MAX, false);
+        total_nodes += count_nodes();
+    }
+    for (const char *fen : data::bench_fens) {
+        board.load_fen(fen);
+        searching = true;
+        search(depth, UINT64_MAX, false);
+        total_nodes += count_nodes();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::chrono::duration<float> time = end - start;
+    print_uci("\n"
+              "Threads: %zu\n"
+              "Nodes: %llu\n"
+              "Time: %lli ms\n"
+              "NPS: %llu\n"
+              "Time per node: %.1f ns\n",
+              helpers.size() + 1,
+              total_nodes,
+              std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
+              (uint64_t)(total_nodes / time.count()),
+              time.count() * 1e9 / total_nodes
+    );
+}
+
 void chess_t::test_movegen() {
     uint32_t failures = 0;
 
@@ -80,17 +153,99 @@ static bool assertf(T expected, T result, const char *fmt, ...) {
     return false;
 }
 
+void chess_t::test_move_validation() {
+    uint32_t failures = 0;
+
+    // every packed move must pass validation if and only if move generation produces it
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        board.load_fen(perft_pos.fen);
+        move_array_t root_moves = gen_moves();
+        for (uint32_t i = 0; i <= root_moves.size; i++) {
+            if (i < root_moves.size) {
+                board.make_move(root_moves[i]);
+            }
+            move_array_t moves = gen_moves();
+            for (uint32_t packed = 1; packed <= UINT16_MAX; packed++) {
+                move_t move = move_t::unpack((uint16_t)packed);
+                bool generated = std::find(moves.begin(), moves.end(), move) != moves.end();
+                bool valid = is_pseudo_legal(move) && is_legal(move);
+                if (generated != valid) {
+                    move.print();
+                    putchar(' ');
+                    failures += assertf(generated, valid, "%s Move %u", perft_pos.fen, i);
+                }
+            }
+            if (i < root_moves.size) {
+                board.undo_move(root_moves[i]);
+            }
+        }
+    }
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
+void chess_t::test_movegen_split() {
+    uint32_t failures = 0;
+
+    // captures plus quiets must equal all moves at every node of the perft tree
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        board.load_fen(perft_pos.fen);
+        uint32_t split_failures = 0;
+        walk(3, [&] {
+            move_array_t moves = gen_moves();
+            move_array_t captures = gen_moves<CAPTURES>();
+            move_array_t quiets = gen_moves<QUIETS>();
+
+            bool failed = captures.size + quiets.size != moves.size;
+            for (move_t &move : captures) {
+                failed |= !(move.is_capture() || move.is_promotion()) || std::find(moves.begin(), moves.end(), move) == moves.end();
+            }
+            for (move_t &move : quiets) {
+                failed |= move.is_capture() || move.is_promotion() || std::find(moves.begin(), moves.end(), move) == moves.end();
+            }
+            split_failures += failed;
+        });
+        failures += assertf(0u, split_failures, "%s Split", perft_pos.name);
+    }
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
 void chess_t::test_transposition_table() {
     uint32_t failures = 0;
 
     constexpr uint64_t key = 1000;
     constexpr uint8_t depth = 1;
-    constexpr uint8_t move_idx = 2;
+    const uint16_t move = move_t(E2, E4, move_t::DOUBLE_PAWN_PUSH).pack();
     constexpr int32_t eval = 0;
-    constexpr transposition_table_t::transposition_data_t expected_result = { eval, move_idx, depth, transposition_table_t::EXACT };
+    transposition_table.allocate();
+    const transposition_table_t::transposition_data_t expected_result = { eval, move, depth, transposition_table_t::EXACT, transposition_table.generation };
 
-    transposition_table.store(eval, move_idx, key, -1, 1, depth);
-    transposition_table_t::transposition_data_t result = transposition_table.lookup(key).data;
+    transposition_table.store(eval, move, key, -1, 1, depth);
+    transposition_table_t::transposition_data_t result;
+    failures += assertf(true, transposition_table.lookup(key, result), "Lookup");
     failures += assertf(expected_result, result, "Store");
 
     for (data::zobrist_test_t zobrist_pos : data::zobrist_test_data) {
@@ -119,6 +274,94 @@ void chess_t::test_transposition_table() {
     }
 }
 
+void chess_t::test_transposition_table_concurrent() {
+    uint32_t failures = 0;
+
+    constexpr uint32_t threads = 4;
+    constexpr uint32_t iterations = 1000000;
+    constexpr uint32_t keys = 16;
+
+    // small table and keys that only differ in the high bits, so every thread hammers the same two buckets
+    transposition_table_t table;
+    table.resize(1);
+
+    // the eval stored for a key is its high bits, so data from one key paired with the xor of another is detectable
+    auto make_key = [](uint32_t i) { return (uint64_t)(i + 1) << 32 | i % 2; };
+    auto key_matches_data = [](uint64_t key, transposition_table_t::transposition_data_t data) {
+        return data.eval == (int32_t)(key >> 32) && (key & 0xffffffffull) == ((key >> 32) - 1) % 2;
+    };
+
+    std::atomic<uint64_t> hits = 0;
+    std::atomic<uint64_t> corrupt_hits = 0;
+    std::atomic<uint64_t> torn_reads = 0;
+
+    std::vector<std::thread> workers;
+    // a writer preempted between its two stores while another writer finishes on the same entry leaves the first word of one
+    // store next to the second word of the other, which is rare without several cores, so this thread writes such pairs directly
+    workers.emplace_back([&]() {
+        for (uint32_t n = 0; n < iterations; n++) {
+            uint32_t i = n % keys;
+            uint32_t j = (i + 2) % keys;
+            transposition_table_t::transposition_data_t first = { (int32_t)(i + 1), 0, 1, transposition_table_t::EXACT, 0 };
+            transposition_table_t::transposition_data_t second = { (int32_t)(j + 1), 0, 1, transposition_table_t::EXACT, 0 };
+            transposition_table_t::transposition_entry_t &entry = table.table[make_key(i) & table.mask].entries[n % transposition_table_t::bucket_entries];
+            entry.data.store(second, std::memory_order_relaxed);
+            entry.data_xor_key.store((uint64_t)first ^ make_key(i), std::memory_order_relaxed);
+            // let the readers see the torn entry before the other writers replace it
+            std::this_thread::yield();
+        }
+    });
+    for (uint32_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (uint32_t n = 0; n < iterations; n++) {
+                uint32_t i = (n * 7 + t) % keys;
+                table.store((int32_t)(i + 1), (uint16_t)t, make_key(i), eval_min, eval_max, (uint8_t)(1 + n % 32));
+            }
+        });
+        workers.emplace_back([&, t]() {
+            for (uint32_t n = 0; n < iterations; n++) {
+                uint32_t i = (n * 5 + t) % keys;
+                uint64_t key = make_key(i);
+                transposition_table_t::transposition_data_t data;
+                if (table.lookup(key, data)) {
+                    hits++;
+                    corrupt_hits += !key_matches_data(key, data);
+                }
+                // count entries rejected because they were read between the two stores of a writer
+                for (transposition_table_t::transposition_entry_t &entry : table.table[key & table.mask].entries) {
+                    uint64_t entry_data = entry.data.load(std::memory_order_relaxed);
+                    uint64_t entry_key = entry_data ^ entry.data_xor_key.load(std::memory_order_relaxed);
+                    torn_reads += entry_data && !key_matches_data(entry_key, transposition_table_t::transposition_data_t::from_uint64(entry_data));
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    printf("Hits: %llu\n"
+           "Rejected Torn Reads: %llu\n\n",
+           hits.load(),
+           torn_reads.load()
+    );
+    failures += assertf((uint64_t)0, corrupt_hits.load(), "Concurrent Lookup");
+    failures += assertf(true, torn_reads.load() > 0, "Torn Reads Seen");
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
 void chess_t::test_draw() {
     uint32_t failures = 0;
 
@@ -148,4 +391,385 @@ void chess_t::test_draw() {
               "\x1b[0m" // puts appends newline
         );
     }
-}
\ No newline at end of file
+}
+
+void chess_t::test_see() {
+    uint32_t failures = 0;
+
+    for (data::see_test_t see_pos : data::see_test_data) {
+        board.load_fen(see_pos.fen);
+        failures += assertf(see_pos.see, see(see_pos.move), see_pos.fen);
+    }
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
+static void flip_fen(const char *fen, char *out) {
+    // mirrors the ranks and swaps the colors, https://www.chessprogramming.org/Color_Flipping
+    char placement[128], to_move[2], castling[5], en_passant[3];
+    uint32_t half_move_clock, full_moves;
+    sscanf(fen, "%127s %1s %4s %2s %u %u", placement, to_move, castling, en_passant, &half_move_clock, &full_moves);
+    char *ranks[8];
+    uint32_t rank_count = 0;
+    for (char *rank = strtok(placement, "/"); rank && rank_count < 8; rank = strtok(nullptr, "/")) {
+        ranks[rank_count++] = rank;
+    }
+    auto swap_case = [](char c) { return (char)(isupper(c) ? tolower(c) : toupper(c)); };
+    char *end = out;
+    for (uint32_t i = rank_count; i-- > 0;) {
+        for (char *c = ranks[i]; *c; c++) {
+            *end++ = swap_case(*c);
+        }
+        *end++ = i ? '/' : ' ';
+    }
+    for (char *c = castling; *c; c++) {
+        *c = *c == '-' ? '-' : swap_case(*c);
+    }
+    if (en_passant[0] != '-') {
+        en_passant[1] = en_passant[1] == '3' ? '6' : '3';
+    }
+    sprintf(end, "%c %s %s %u %u", to_move[0] == 'w' ? 'b' : 'w', castling, en_passant, half_move_clock, full_moves);
+}
+
+void chess_t::test_eval() {
+    uint32_t failures = 0;
+
+    // make_move and undo_move must keep the piece-square score, the phase and the pawn key equal to a full recount at every node
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        board.load_fen(perft_pos.fen);
+        uint32_t eval_failures = 0;
+        walk(3, [&] {
+            int32_t phase = 0;
+            for (uint32_t piece = PAWN; piece <= KING; piece++) {
+                phase += (int32_t)intrin::popcnt(board.bitboards[WHITE][piece] | board.bitboards[BLACK][piece]) * data::phase_values[piece];
+            }
+            uint64_t pawn_key = 0;
+            for (uint32_t color = WHITE; color <= BLACK; color++) {
+                for (uint64_t pawns = board.bitboards[color][PAWN]; pawns; pawns = intrin::blsr(pawns)) {
+                    pawn_key ^= data::zobrist_random_data.piece[color][PAWN][intrin::ctz(pawns)];
+                }
+            }
+            board_t::game_state_t *game_state = board.game_state_stack.last();
+            eval_failures += game_state->psqt != count_material<WHITE>() - count_material<BLACK>() || game_state->phase != phase ||
+                             game_state->pawn_key != pawn_key;
+        });
+        failures += assertf(0u, eval_failures, "%s Eval", perft_pos.name);
+    }
+
+    for (data::pawn_structure_test_t pawn_pos : data::pawn_structure_test_data) {
+        board.load_fen(pawn_pos.fen);
+        uint64_t passed[2];
+        eval_pawns<WHITE>(passed[WHITE]);
+        eval_pawns<BLACK>(passed[BLACK]);
+        failures += assertf(pawn_pos.passed[WHITE], passed[WHITE], "%s White Passed Pawns", pawn_pos.fen);
+        failures += assertf(pawn_pos.passed[BLACK], passed[BLACK], "%s Black Passed Pawns", pawn_pos.fen);
+    }
+
+    // the pawn structure of the starting position is symmetric
+    board.load_fen(data::startpos_fen);
+    failures += assertf(0, probe_pawn_table().score, "Start Position Pawn Structure");
+
+    // the side to move sees the same evaluation after swapping the colors and flipping the board
+    for (const char *fen : data::bench_fens) {
+        char flipped[128];
+        flip_fen(fen, flipped);
+        board.load_fen(fen);
+        int32_t expected = eval();
+        board.load_fen(flipped);
+        failures += assertf(expected, eval(), "%s Flipped Eval", fen);
+    }
+
+    // a value returned at the lazy eval gate must be on the same side of the window as the full eval
+    bool saved_lazy_eval = lazy_eval;
+    lazy_eval = true;
+    auto test_lazy_eval = [&](const char *fen) {
+        board.load_fen(fen);
+        int32_t full = eval();
+        for (int32_t alpha = full - 2 * lazy_eval_margin; alpha <= full + 2 * lazy_eval_margin; alpha += 25) {
+            failures += assertf(full <= alpha, eval(alpha, alpha + 1) <= alpha, "%s Lazy Eval %d", fen, alpha);
+        }
+    };
+    for (const char *fen : data::bench_fens) {
+        test_lazy_eval(fen);
+    }
+    // three queens against the bare king push the unclamped piece terms well past the margin
+    test_lazy_eval("6k1/8/3Q1Q1Q/8/8/2B5/1B5R/6RK w - - 0 1");
+    lazy_eval = saved_lazy_eval;
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
+void chess_t::test_nnue() {
+    uint32_t failures = 0;
+
+    std::unique_ptr<nnue_network_t> loaded_network = std::move(nnue_network);
+    random_nnue(1);
+    // make_move must keep the accumulators equal to a refresh, and both output paths must agree
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        board.load_fen(perft_pos.fen);
+        uint32_t nnue_failures = 0;
+        walk(3, [&] {
+            nnue_accumulator_t accumulator;
+            nnue_refresh(accumulator, board);
+            color_t to_move = board.game_state_stack.last()->to_move;
+            nnue_failures += memcmp(&accumulator, &board.accumulator(), sizeof(accumulator)) != 0 ||
+                             nnue_evaluate(board.accumulator(), to_move) != nnue_evaluate_scalar(accumulator, to_move);
+            board.make_null_move();
+            nnue_failures += memcmp(&accumulator, &board.accumulator(), sizeof(accumulator)) != 0;
+            board.undo_null_move();
+        });
+        failures += assertf(0u, nnue_failures, "%s NNUE", perft_pos.name);
+    }
+    nnue_network = std::move(loaded_network);
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
+void chess_t::test_uci() {
+    uint32_t failures = 0;
+
+    failures += assertf(true, opening_book.set_book("Titans.bin"), "Opening Book");
+
+    // go ponder straight after stopping a search used to set pondering while the previous search was still returning,
+    // which then held back its bestmove forever while the uci thread waited for it to finish
+    std::future<void> commands = std::async(std::launch::async, [this] {
+        char fen_command[128];
+        snprintf(fen_command, sizeof(fen_command), "position fen %s", data::bench_fens[0]);
+        const char *sequence[] = { fen_command, "go depth 2", "stop", fen_command, "go ponder", "stop", "isready" };
+        for (uint32_t i = 0; i < 20; i++) {
+            for (const char *command : sequence) {
+                char input[128];
+                strcpy(input, command);
+                uci_command(input);
+            }
+        }
+        worker.wait();
+    });
+    bool finished = commands.wait_for(std::chrono::seconds(30)) == std::future_status::ready;
+    failures += assertf(true, finished, "Stop Then Go Ponder");
+    // release every remaining deadlock so the failure is reported
+    while (commands.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+        pondering = false;
+        notify_search();
+    }
+
+    if (failures) {
+        printf("\x1b[31m"
+               "%d tests failed."
+               "\x1b[0m\n",
+                failures
+        );
+    } else {
+        puts("\x1b[32m"
+              "All tests succeeded!"
+              "\x1b[0m" // puts appends newline
+        );
+    }
+}
+
+void chess_t::bench_see() {
+    // repeated SEE of every capture in the perft and bench positions
+    constexpr uint32_t iterations = 10000;
+    uint64_t calls = 0;
+    int64_t total_see = 0;
+    std::chrono::duration<float> time{};
+    auto bench_position = [&](const char *fen) {
+        board.load_fen(fen);
+        move_array_t captures = gen_moves<CAPTURES>();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            for (move_t &move : captures) {
+                total_see += see(move);
+            }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        time += end - start;
+        calls += (uint64_t)iterations * captures.size;
+    };
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        bench_position(perft_pos.fen);
+    }
+    for (const char *fen : data::bench_fens) {
+        bench_position(fen);
+    }
+    print_uci("\n"
+              "SEE calls: %llu\n"
+              "Average SEE: %.1f\n"
+              "Time: %lli ms\n"
+              "SEE calls/s: %llu\n",
+              calls,
+              (double)total_see / calls,
+              std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
+              (uint64_t)(calls / time.count())
+    );
+}
+
+void chess_t::bench_nnue() {
+    // output layer throughput over the perft and bench positions, then the make_move cost of the accumulator updates
+    constexpr uint32_t iterations = 100000;
+    constexpr uint32_t perft_depth = 4;
+    bool random_network = !nnue_network;
+    if (random_network) {
+        random_nnue(1);
+    }
+    std::vector<nnue_accumulator_t> accumulators;
+    std::vector<color_t> to_move;
+    auto add_position = [&](const char *fen) {
+        board.load_fen(fen);
+        accumulators.push_back(board.accumulator());
+        to_move.push_back(board.game_state_stack.last()->to_move);
+    };
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        add_position(perft_pos.fen);
+    }
+    for (const char *fen : data::bench_fens) {
+        add_position(fen);
+    }
+    auto time_evals = [&](int32_t (*evaluate)(const nnue_accumulator_t &, color_t)) {
+        int64_t total_eval = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            for (uint32_t j = 0; j < accumulators.size(); j++) {
+                total_eval += evaluate(accumulators[j], to_move[j]);
+            }
+        }
+        std::chrono::duration<float> time = std::chrono::steady_clock::now() - start;
+        return std::make_pair((uint64_t)(iterations * accumulators.size() / time.count()), total_eval);
+    };
+    std::pair<uint64_t, int64_t> simd = time_evals(nnue_evaluate);
+    std::pair<uint64_t, int64_t> scalar = time_evals(nnue_evaluate_scalar);
+
+    auto time_perft = [&]() {
+        uint64_t nodes = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (data::perft_result_t perft_pos : data::perft_results) {
+            board.load_fen(perft_pos.fen);
+            nodes += perft(perft_depth, false);
+        }
+        std::chrono::duration<float> time = std::chrono::steady_clock::now() - start;
+        return (uint64_t)(nodes / time.count());
+    };
+    uint64_t perft_nnue_nps = time_perft();
+    std::unique_ptr<nnue_network_t> network = std::move(nnue_network);
+    uint64_t perft_nps = time_perft();
+    nnue_network = std::move(network);
+
+    if (random_network) {
+        nnue_network.reset();
+    }
+    print_uci("\n"
+              "Network: %s\n"
+              "Evals/s: %llu\n"
+              "Scalar evals/s: %llu\n"
+              "Outputs match: %s\n"
+              "Perft NPS with accumulators: %llu\n"
+              "Perft NPS without: %llu\n",
+              random_network ? "random" : "EvalFile",
+              simd.first,
+              scalar.first,
+              simd.second == scalar.second ? "yes" : "no",
+              perft_nnue_nps,
+              perft_nps
+    );
+}
+
+void chess_t::bench_eval() {
+    // eval() at every node of a shallow tree walk from the perft and bench positions, which keeps the
+    // pawn structure changing between neighbouring nodes like in a search, minus the cost of the walk itself
+    constexpr uint32_t walk_depth = 3;
+    constexpr uint32_t runs = 5;
+    std::unique_ptr<nnue_network_t> network = std::move(nnue_network);
+    bool lazy = lazy_eval;
+    lazy_eval = true;
+    int64_t total_eval = 0;
+    // the fastest of a few runs, the differences are small next to the walk
+    auto time_walk = [&](auto &&visit) {
+        uint64_t nodes = 0;
+        float best_time = std::numeric_limits<float>::max();
+        for (uint32_t run = 0; run < runs; run++) {
+            nodes = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (data::perft_result_t perft_pos : data::perft_results) {
+                board.load_fen(perft_pos.fen);
+                nodes += walk(walk_depth, visit);
+            }
+            for (const char *fen : data::bench_fens) {
+                board.load_fen(fen);
+                nodes += walk(walk_depth, visit);
+            }
+            std::chrono::duration<float> time = std::chrono::steady_clock::now() - start;
+            best_time = std::min(best_time, time.count());
+        }
+        return std::make_pair(nodes, best_time);
+    };
+    std::pair<uint64_t, float> base = time_walk([] {});
+    // hit rate from an empty table, the timed runs below keep reusing it
+    stats = {};
+    std::fill(pawn_table.get(), pawn_table.get() + pawn_table_entries, pawn_entry_t {});
+    for (data::perft_result_t perft_pos : data::perft_results) {
+        board.load_fen(perft_pos.fen);
+        walk(walk_depth, [&] { total_eval += eval(); });
+    }
+    for (const char *fen : data::bench_fens) {
+        board.load_fen(fen);
+        walk(walk_depth, [&] { total_eval += eval(); });
+    }
+    search_stats_t eval_stats = stats;
+    std::pair<uint64_t, float> evals = time_walk([&] { total_eval += eval(); });
+    // an empty window makes every call stop at the lazy eval gate, before the piece terms
+    std::pair<uint64_t, float> lazy_evals = time_walk([&] { total_eval += eval(eval_max, eval_max); });
+    std::pair<uint64_t, float> pawns = time_walk([&] {
+        uint64_t passed[2];
+        total_eval += eval_pawns<WHITE>(passed[WHITE]) - eval_pawns<BLACK>(passed[BLACK]);
+    });
+    nnue_network = std::move(network);
+    lazy_eval = lazy;
+
+    print_uci("\n"
+              "Nodes: %llu\n"
+              "Eval: %.1f ns\n"
+              "Eval stopped by the lazy eval gate: %.1f ns\n"
+              "Pawn structure without the pawn hash table: %.1f ns\n"
+              "Pawn hash hit rate: %.1f%%\n"
+              "Checksum: %lld\n",
+              evals.first,
+              (evals.second - base.second) * 1e9 / evals.first,
+              (lazy_evals.second - base.second) * 1e9 / lazy_evals.first,
+              (pawns.second - base.second) * 1e9 / pawns.first,
+              100.0 * eval_stats.pawn_hits / std::max<uint64_t>(eval_stats.pawn_probes, 1),
+              total_eval
+    );
+}
@@ -0,0 +1,42 @@
+#include "chess.h"
+
+chess_t::worker_t::worker_t() : thread(&worker_t::loop, this) {}
+
+chess_t::worker_t::~worker_t() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void chess_t::worker_t::run(std::function<void()> new_job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !busy; });
+    job = std::move(new_job);
+    busy = true;
+    cv.notify_all();
+}
+
+void chess_t::worker_t::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !busy; });
+}
+
+void chess_t::worker_t::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return busy || exiting; });
+        // a job handed over before exiting still runs
+        if (busy) {
+            lock.unlock();
+            job();
+            lock.lock();
+            busy = false;
+            cv.notify_all();
+        } else {
+            return;
+        }
+    }
+}
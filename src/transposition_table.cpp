@@ -1,22 +1,107 @@
 #include "chess.h"
 
-chess_t::transposition_table_t::transposition_entry_t chess_t::transposition_table_t::lookup(uint64_t key) {
-    uint32_t idx = key % entries;
-    return table[idx];
+chess_t::transposition_table_t chess_t::transposition_table;
+
+bool chess_t::transposition_table_t::resize(uint64_t size_mb) {
+    uint64_t new_buckets = std::bit_floor(size_mb * 1024 * 1024 / sizeof(*table));
+    transposition_bucket_t *new_table = new (std::nothrow) transposition_bucket_t[new_buckets] {};
+    if (new_table == nullptr) {
+        return false;
+    }
+    delete[] table;
+    table = new_table;
+    buckets = new_buckets;
+    mask = buckets - 1;
+    return true;
 }
-void chess_t::transposition_table_t::store(int32_t eval, uint8_t move_idx, uint64_t key, int32_t alpha, int32_t beta, uint8_t depth) {
-    uint32_t idx = key % entries;
 
-    if (table[idx].data.depth >= depth) {
-        return; // only store if depth is greater, unwritten entries have a depth of 0
+void chess_t::transposition_table_t::allocate() {
+    if (table == nullptr && !resize(default_size_mb)) {
+        printf("new in transposition_table_t::allocate() failed: %llu MB\n", default_size_mb);
+        exit(1);
     }
+}
 
-    transposition_data_t data = { eval, move_idx, depth, EXACT };
+uint64_t chess_t::transposition_table_t::size_mb() {
+    return buckets * sizeof(*table) / (1024 * 1024);
+}
+
+void chess_t::transposition_table_t::clear() {
+    for (uint64_t i = 0; i < buckets; i++) {
+        for (transposition_entry_t &entry : table[i].entries) {
+            entry.data.store(0, std::memory_order_relaxed);
+            entry.data_xor_key.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void chess_t::transposition_table_t::new_search() {
+    generation = (generation + 1) & max_generation;
+}
+
+uint32_t chess_t::transposition_table_t::hashfull() {
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < 1000 / bucket_entries; i++) {
+        for (transposition_entry_t &entry : table[i].entries) {
+            transposition_data_t data = transposition_data_t::from_uint64(entry.data.load(std::memory_order_relaxed));
+            used += data.depth != 0 && data.generation == generation;
+        }
+    }
+    return used;
+}
+
+bool chess_t::transposition_table_t::lookup(uint64_t key, transposition_data_t &data) {
+    transposition_bucket_t &bucket = table[key & mask];
+    for (transposition_entry_t &entry : bucket.entries) {
+        uint64_t entry_data = entry.data.load(std::memory_order_relaxed);
+        uint64_t entry_data_xor_key = entry.data_xor_key.load(std::memory_order_relaxed);
+        if ((entry_data ^ entry_data_xor_key) == key) {
+            data = transposition_data_t::from_uint64(entry_data);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool chess_t::transposition_table_t::store(int32_t eval, uint16_t move, uint64_t key, int32_t alpha, int32_t beta, uint8_t depth) {
+    transposition_bucket_t &bucket = table[key & mask];
+
+    // replace the entry for the same position if there is one, otherwise the one with the lowest depth and largest age
+    transposition_entry_t *replace = nullptr;
+    transposition_data_t replace_data = {};
+    bool same_position = false;
+    int32_t replace_score = INT32_MAX;
+    for (transposition_entry_t &entry : bucket.entries) {
+        uint64_t entry_data = entry.data.load(std::memory_order_relaxed);
+        uint64_t entry_data_xor_key = entry.data_xor_key.load(std::memory_order_relaxed);
+        transposition_data_t data = transposition_data_t::from_uint64(entry_data);
+        if ((entry_data ^ entry_data_xor_key) == key) {
+            if (data.depth > depth && data.generation == generation) {
+                return false; // keep deeper results from the current search
+            }
+            replace = &entry;
+            same_position = true;
+            break;
+        }
+        uint32_t age = (generation - data.generation) & max_generation;
+        int32_t score = data.depth - 8 * (int32_t)age;
+        if (score < replace_score) {
+            replace = &entry;
+            replace_data = data;
+            replace_score = score;
+        }
+    }
+
+    bool overwrite = !same_position && replace_data.depth != 0;
+
+    transposition_data_t data = { eval, move, depth, EXACT, generation };
     if (eval <= alpha) {
         data.type = UPPERBOUND;
     } else if (eval >= beta) {
         data.type = LOWERBOUND;
     }
-    table[idx].data = data;
-    table[idx].data_xor_key = (uint64_t)data ^ key;
-}
\ No newline at end of file
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->data_xor_key.store((uint64_t)data ^ key, std::memory_order_relaxed);
+    return overwrite;
+}
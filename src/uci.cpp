@@ -17,12 +17,16 @@ void chess_t::flush_uci() {
 
 void chess_t::print_uci(const char *fmt, ...) {
     va_list args;
+    va_list log_args;
     va_start(args, fmt);
+    // vprintf consumes args, so the log needs its own copy
+    va_copy(log_args, args);
 
     vprintf(fmt, args);
-    vfprintf(log, fmt, args);
+    vfprintf(log, fmt, log_args);
     flush_uci();
 
+    va_end(log_args);
     va_end(args);
 }
 
@@ -31,8 +35,9 @@ chess_t::go_options_t chess_t::parse_go_command() {
         { (std::chrono::milliseconds)0, (std::chrono::milliseconds)0, },
         { (std::chrono::milliseconds)0, (std::chrono::milliseconds)0, },
         false,
+        false,
         UINT32_MAX,
-        UINT32_MAX,
+        UINT64_MAX,
         (std::chrono::milliseconds)0,
     };
 
@@ -50,11 +55,15 @@ chess_t::go_options_t chess_t::parse_go_command() {
         } else if (!strcmp(option, "depth")) {
             go_options.max_depth = atoi(strtok(nullptr, " "));
         } else if (!strcmp(option, "nodes")) {
-            go_options.max_nodes = atoi(strtok(nullptr, " "));
+            go_options.max_nodes = atoll(strtok(nullptr, " "));
         } else if (!strcmp(option, "movetime")) {
             go_options.input_move_time = (std::chrono::milliseconds)atoll(strtok(nullptr, " "));
         } else if (!strcmp(option, "infinite")) {
             go_options.infinite = true;
+        } else if (!strcmp(option, "ponder")) {
+            // go ponder without limits becomes an infinite search on ponderhit
+            go_options.ponder = true;
+            continue;
         }
         empty = false;
     }
@@ -91,15 +100,117 @@ void chess_t::parse_position_command() {
     }
 }
 
+void chess_t::parse_setoption_command() {
+    strtok(nullptr, " "); // name
+    char *name = strtok(nullptr, " ");
+    strtok(nullptr, " "); // value
+    char *value = strtok(nullptr, " ");
+    if (!name || !value) {
+        return;
+    }
+    if (!strcmp(name, "Threads")) {
+        set_threads(std::clamp(atoi(value), 1, 256));
+    } else if (!strcmp(name, "NullMoveVerification")) {
+        null_move_verification = !strcmp(value, "true");
+    } else if (!strcmp(name, "LazyEval")) {
+        lazy_eval = !strcmp(value, "true");
+    } else if (!strcmp(name, "LMRBase")) {
+        lmr_base = std::clamp(atoi(value), 0, 300);
+        init_lmr_reductions();
+    } else if (!strcmp(name, "LMRDivisor")) {
+        lmr_divisor = std::clamp(atoi(value), 100, 1000);
+        init_lmr_reductions();
+    } else if (!strcmp(name, "MultiPV")) {
+        multi_pv = std::clamp(atoi(value), 1, (int32_t)max_multi_pv);
+    } else if (!strcmp(name, "Hash")) {
+        uint64_t size_mb = std::clamp(atoll(value), 1ll, (long long)transposition_table_t::max_size_mb);
+        if (!transposition_table.resize(size_mb)) {
+            print_uci("info string failed to allocate a %llu MB hash table, keeping %llu MB\n", size_mb,
+                      transposition_table.table ? transposition_table.size_mb() : transposition_table_t::default_size_mb);
+        }
+    } else if (!strcmp(name, "EvalFile")) {
+        if (!strcmp(value, "<empty>")) {
+            nnue_network.reset();
+        } else if (load_nnue(value)) {
+            board.refresh_accumulator();
+            print_uci("info string loaded network %s\n", value);
+        } else {
+            print_uci("info string failed to load network %s, using %s\n", value, nnue_network ? "the previous network" : "piece-square tables");
+        }
+    }
+}
+
+bool chess_t::get_ponder_move(move_t &ponder_move) {
+    // the expected reply is the second move of the principal variation, or the hash move after the best move if the PV was cut short
+    if (pv_lines[0].length >= 2) {
+        ponder_move = pv_lines[0].moves[1];
+        return true;
+    }
+    if (pv_lines[0].length == 0) {
+        return false; // book move
+    }
+    board.make_move(best_move);
+    transposition_table_t::transposition_data_t entry;
+    bool found = transposition_table.lookup(board.game_state_stack.last()->zobrist_key, entry);
+    ponder_move = move_t::unpack(entry.move);
+    found = found && is_pseudo_legal(ponder_move) && is_legal(ponder_move);
+    board.undo_move(best_move);
+    return found;
+}
+
+void chess_t::ponderhit() {
+    if (pondering) {
+        std::chrono::duration<float> time = std::chrono::steady_clock::now() - ponder_start;
+        print_uci("info string pondered %lli ms\n", std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
+        pondering = false;
+        notify_search();
+    }
+}
+
 int32_t chess_t::search_uci(std::chrono::milliseconds time, bool infinite, uint32_t max_depth, uint64_t max_nodes) {
     int32_t eval = infinite ? search(max_depth, max_nodes, false) : search_timed(time, max_depth, max_nodes);
+    // bestmove is held back until ponderhit or stop even if the search has finished
+    {
+        std::unique_lock<std::mutex> lock(search_mutex);
+        search_cv.wait(lock, [this] { return !pondering; });
+    }
     
+    // a search stopped before depth 1 completed has no best move, any legal move is better than the null move
+    if (best_move == move_t::unpack(0)) {
+        move_array_t moves = gen_moves();
+        if (moves.size > 0) {
+            best_move = moves[0];
+        }
+    }
     print_uci("bestmove ");
-    best_move.print();
-    best_move.print(log);
+    if (best_move == move_t::unpack(0)) {
+        print_uci("0000"); // checkmate or stalemate
+    } else {
+        best_move.print();
+        best_move.print(log);
+    }
+    move_t ponder_move;
+    if (get_ponder_move(ponder_move)) {
+        print_uci(" ponder ");
+        ponder_move.print();
+        ponder_move.print(log);
+    }
+    search_stats_t total_stats = count_stats();
     print_uci("\n"
-               "info string %d nodes searched\n",
-               nodes
+               "info string %llu nodes searched (%llu quiescence)\n"
+               "info string tt hit rate %.1f%% overwrite rate %.1f%%\n"
+               "info string pawn hash hit rate %.1f%% lazy eval rate %.1f%%\n"
+               "info string %llu null move cutoffs %llu see prunes\n"
+               "info string first move cutoff rate %.1f%%\n",
+               count_nodes(),
+               total_stats.qnodes,
+               100.0 * total_stats.tt_hits / std::max<uint64_t>(total_stats.tt_probes, 1),
+               100.0 * total_stats.tt_overwrites / std::max<uint64_t>(total_stats.tt_stores, 1),
+               100.0 * total_stats.pawn_hits / std::max<uint64_t>(total_stats.pawn_probes, 1),
+               100.0 * total_stats.lazy_evals / std::max<uint64_t>(total_stats.evals, 1),
+               total_stats.null_move_cutoffs,
+               total_stats.see_prunes,
+               100.0 * total_stats.first_move_cutoffs / std::max<uint64_t>(total_stats.beta_cutoffs, 1)
     );
 
     return eval;
@@ -111,60 +222,107 @@ void chess_t::uci() {
         char input[64 * 1024];
         fgets(input, sizeof(input) / sizeof(input[0]), stdin);
         input[strcspn(input, "\n")] = '\0';
-        
-        log_uci("%s\n", input);
-
-        char *command = strtok(input, " ");
-        if (command) {
-            if (!strcmp(command, "uci")) {
-                print_uci("id name Glamdring\n"
-                          "id author sublinear\n"
-                          "uciok\n");
-            } else if (!strcmp(command, "isready")) {
-                print_uci("readyok\n");
-            } else if (!strcmp(command, "stop")) {
-                stop_search();
-            } else if (!strcmp(command, "quit")) {
-                stop_search();
-                return;
-            } else {
-                if (searching) {
-                    continue;
+        if (!uci_command(input)) {
+            return;
+        }
+    }
+}
+
+bool chess_t::uci_command(char *input) {
+    log_uci("%s\n", input);
+
+    char *command = strtok(input, " ");
+    if (command) {
+        if (!strcmp(command, "uci")) {
+            print_uci("id name Glamdring\n"
+                      "id author sublinear\n"
+                      "option name Threads type spin default 1 min 1 max 256\n"
+                      "option name Ponder type check default false\n"
+                      "option name Hash type spin default %llu min 1 max %llu\n"
+                      "option name NullMoveVerification type check default false\n"
+                      "option name LazyEval type check default true\n"
+                      "option name LMRBase type spin default %d min 0 max 300\n"
+                      "option name LMRDivisor type spin default %d min 100 max 1000\n"
+                      "option name MultiPV type spin default 1 min 1 max %u\n"
+                      "option name EvalFile type string default <empty>\n"
+                      "uciok\n",
+                      transposition_table_t::default_size_mb,
+                      transposition_table_t::max_size_mb,
+                      lmr_base,
+                      lmr_divisor,
+                      max_multi_pv);
+        } else if (!strcmp(command, "isready")) {
+            transposition_table.allocate();
+            print_uci("readyok\n");
+        } else if (!strcmp(command, "stop")) {
+            ponderhit();
+            stop_search();
+        } else if (!strcmp(command, "ponderhit")) {
+            ponderhit();
+        } else if (!strcmp(command, "quit")) {
+            pondering = false;
+            stop_search();
+            return false;
+        } else {
+            // a search, or a finished search holding back its bestmove for ponderhit, is only told to stop
+            if (searching || pondering) {
+                return true;
+            }
+            // the previous search may still be printing its results, which reads the board and the transposition table
+            worker.wait();
+            if (!strcmp(command, "go")) {
+                go_options_t go_options = parse_go_command();
+
+                color_t to_move = board.game_state_stack.last()->to_move;
+                std::chrono::milliseconds move_time = get_search_time(go_options.time[to_move], go_options.inc[to_move], go_options.input_move_time);
+
+                if (move_time > (std::chrono::milliseconds)0) {
+                    print_uci("info string searching for %d ms\n", move_time);
                 }
-                if (!strcmp(command, "go")) {
-                    go_options_t go_options = parse_go_command();
-
-                    color_t to_move = board.game_state_stack.last()->to_move;
-                    std::chrono::milliseconds move_time = get_search_time(go_options.time[to_move], go_options.inc[to_move], go_options.input_move_time);
-
-                    if (move_time > (std::chrono::milliseconds)0) {
-                        print_uci("info string searching for %d ms\n", move_time);
-                    }
-
-                    std::thread search_thread { &chess_t::search_uci, this, move_time, go_options.infinite, go_options.max_depth, go_options.max_nodes };
-                    search_thread.detach();
-                } else if (!strcmp(command, "perft")) {
-                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-                    uint64_t perft_result = perft(atoi(strtok(nullptr, " ")));
-                    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-                    std::chrono::duration<float> time = end - start;
-                    print_uci("\n"
-                              "Nodes: %llu\n"
-                              "Time: %lli ms\n"
-                              "NPS: %llu\n",
-                              perft_result,
-                              std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
-                              (uint64_t)(perft_result / time.count())
-                    );
-                } else if (!strcmp(command, "position")) {
-                    parse_position_command();
-                } else if (!strcmp(command, "d")) {
-                    board.print();
-                    board.print(log);
-                } else if (!strcmp(command, "eval")) {
-                    print_uci("%d\n", eval());
+                transposition_table.allocate();
+                // set before handing off so that a stop right after go cannot be overwritten, and only once the
+                // previous search has returned, since it holds back its bestmove while pondering is set
+                pondering = go_options.ponder;
+                ponder_start = std::chrono::steady_clock::now();
+                searching = true;
+                worker.run([this, move_time, go_options] {
+                    search_uci(move_time, go_options.infinite, go_options.max_depth, go_options.max_nodes);
+                });
+            } else if (!strcmp(command, "perft")) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                uint64_t perft_result = perft(atoi(strtok(nullptr, " ")));
+                std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+                std::chrono::duration<float> time = end - start;
+                print_uci("\n"
+                          "Nodes: %llu\n"
+                          "Time: %lli ms\n"
+                          "NPS: %llu\n",
+                          perft_result,
+                          std::chrono::duration_cast<std::chrono::milliseconds>(time).count(),
+                          (uint64_t)(perft_result / time.count())
+                );
+            } else if (!strcmp(command, "bench")) {
+                char *depth = strtok(nullptr, " ");
+                if (depth && !strcmp(depth, "see")) {
+                    bench_see();
+                } else if (depth && !strcmp(depth, "nnue")) {
+                    bench_nnue();
+                } else if (depth && !strcmp(depth, "eval")) {
+                    bench_eval();
+                } else {
+                    bench(depth ? atoi(depth) : 6);
                 }
+            } else if (!strcmp(command, "setoption")) {
+                parse_setoption_command();
+            } else if (!strcmp(command, "position")) {
+                parse_position_command();
+            } else if (!strcmp(command, "d")) {
+                board.print();
+                board.print(log);
+            } else if (!strcmp(command, "eval")) {
+                print_uci("%d\n", eval());
             }
         }
     }
-}
\ No newline at end of file
+    return true;
+}
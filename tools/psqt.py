@@ -1,6 +1,11 @@
-from pprint import pprint
+# generates data::piece_square_values[2][6][64] (middlegame, endgame) in static_data.cpp
+# tables from https://www.chessprogramming.org/Simplified_Evaluation_Function, which only
+# distinguishes the king between the middlegame and the endgame; the other pieces share one table
+piece_values = [
+    100, 320, 330, 500, 900, 0
+]
 
-piece_values = [[
+pawn = [
     0,  0,  0,  0,  0,  0,  0,  0,
     50, 50, 50, 50, 50, 50, 50, 50,
     10, 10, 20, 30, 30, 20, 10, 10,
@@ -9,8 +14,8 @@ piece_values = [[
     5, -5,-10,  0,  0,-10, -5,  5,
     5, 10, 10,-20,-20, 10, 10,  5,
     0,  0,  0,  0,  0,  0,  0,  0,
-],
-[
+]
+knight = [
     -50,-40,-30,-30,-30,-30,-40,-50,
     -40,-20,  0,  0,  0,  0,-20,-40,
     -30,  0, 10, 15, 15, 10,  0,-30,
@@ -19,8 +24,8 @@ piece_values = [[
     -30,  5, 10, 15, 15, 10,  5,-30,
     -40,-20,  0,  5,  5,  0,-20,-40,
     -50,-40,-30,-30,-30,-30,-40,-50,
-],
-[
+]
+bishop = [
     -20,-10,-10,-10,-10,-10,-10,-20,
     -10,  0,  0,  0,  0,  0,  0,-10,
     -10,  0,  5, 10, 10,  5,  0,-10,
@@ -29,8 +34,8 @@ piece_values = [[
     -10, 10, 10, 10, 10, 10, 10,-10,
     -10,  5,  0,  0,  0,  0,  5,-10,
     -20,-10,-10,-10,-10,-10,-10,-20,
-],
-[
+]
+rook = [
     0,  0,  0,  0,  0,  0,  0,  0,
     5, 10, 10, 10, 10, 10, 10,  5,
     -5,  0,  0,  0,  0,  0,  0, -5,
@@ -39,8 +44,8 @@ piece_values = [[
     -5,  0,  0,  0,  0,  0,  0, -5,
     -5,  0,  0,  0,  0,  0,  0, -5,
     0,  0,  0,  5,  5,  0,  0,  0,
-],
-[
+]
+queen = [
     -20,-10,-10, -5, -5,-10,-10,-20,
     -10,  0,  0,  0,  0,  0,  0,-10,
     -10,  0,  5,  5,  5,  5,  0,-10,
@@ -49,19 +54,41 @@ piece_values = [[
     -10,  5,  5,  5,  5,  5,  0,-10,
     -10,  0,  5,  0,  0,  0,  0,-10,
     -20,-10,-10, -5, -5,-10,-10,-20,
-    ],
 ]
-piece_square_values = [
-    100, 320, 330, 500, 900, 0, 0
+king_middlegame = [
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20,
+]
+king_endgame = [
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50,
+]
+
+phases = [
+    ('middlegame', [pawn, knight, bishop, rook, queen, king_middlegame]),
+    ('endgame', [pawn, knight, bishop, rook, queen, king_endgame]),
 ]
 
-for i, piece_square_value in enumerate(piece_square_values):
-    print('{')
-    for j, value in enumerate(piece_square_value):
-        if j % 8 == 0:
-            print('    ', end='')
-        combined = piece_values[i] + value
-        if combined < 100:
-            print(' ', end='')
-        print(combined, end=',\n' if j % 8 == 7 else ', ')
-    print('},')
\ No newline at end of file
+for name, tables in phases:
+    print('    // ' + name)
+    print('    {')
+    for piece_value, table in zip(piece_values, tables):
+        print('        {')
+        for j, value in enumerate(table):
+            if j % 8 == 0:
+                print('            ', end='')
+            print('%3d' % (piece_value + value), end=',\n' if j % 8 == 7 else ', ')
+        print('        },')
+    print('    },')